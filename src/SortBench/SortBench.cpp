@@ -21,6 +21,7 @@
 #include <cstring>
 #include <memory>
 #include <vector>
+#include <queue>
 #include <algorithm>
 
 #include "jstd/SortAlgorithms.h"
@@ -75,6 +76,46 @@ struct Algorithm {
         ska_sort_copy,
         ska_sort_wide,
         ska_sort_copy_wide,
+        jstdSortBatch,
+        jstdSegmentedSort,
+        jstdParallelSort_1T,
+        jstdParallelSort_2T,
+        jstdParallelSort_4T,
+        jstdParallelSort_8T,
+        jstdParallelSort_NT,
+        jstdParallelStableSort_NT,
+        ska_sort_parallel_NT,
+        ska_sort_copy_parallel_NT,
+        ska_sort_Pdqsort,
+        ska_sort_Insertion,
+        ska_sort_Network,
+        ska_sort_L1,
+        ska_sort_L2,
+        jstdStringSort,
+        jstdSortPermute,
+        stdPartialSort,
+        jstdPartialSort,
+        stdNthElement,
+        jstdNthElement,
+        jstdTopK,
+        stdMerge,
+        stdPriorityQueueMerge,
+        jstdMergeK,
+        jstdMergeKBranchless,
+        stdInplaceMerge,
+        jstdSortedInsertBatch,
+        jstdSentinelInsertSort,
+        jstdPairInsertSort,
+        jstdHistogramSortSentinel,
+        jstdHistogramSortPair,
+        sgiIntroSortSentinel,
+        sgiIntroSortPair,
+        jstdQuadSmallSort,
+        jstdHistogramSortQuad,
+        sgiIntroSortQuad,
+        ska_sort_Quad,
+        jstdHistogramSortReverse,
+        jstdHistogramSortDescending,
         Last
     };
 };
@@ -124,10 +165,104 @@ const char * getSortAlgorithmName()
         return "ska_sort (wide)";
     else if (AlgorithmId == Algorithm::ska_sort_copy_wide)
         return "ska_sort_copy (wide)";
+    else if (AlgorithmId == Algorithm::jstdSortBatch)
+        return "jstd::sort_batch";
+    else if (AlgorithmId == Algorithm::jstdSegmentedSort)
+        return "jstd::segmented_sort";
+    else if (AlgorithmId == Algorithm::jstdParallelSort_1T)
+        return "jstd::parallel_sort (1T)";
+    else if (AlgorithmId == Algorithm::jstdParallelSort_2T)
+        return "jstd::parallel_sort (2T)";
+    else if (AlgorithmId == Algorithm::jstdParallelSort_4T)
+        return "jstd::parallel_sort (4T)";
+    else if (AlgorithmId == Algorithm::jstdParallelSort_8T)
+        return "jstd::parallel_sort (8T)";
+    else if (AlgorithmId == Algorithm::jstdParallelSort_NT)
+        return "jstd::parallel_sort (NT)";
+    else if (AlgorithmId == Algorithm::jstdParallelStableSort_NT)
+        return "jstd::parallel_stable_sort";
+    else if (AlgorithmId == Algorithm::ska_sort_parallel_NT)
+        return "ska_sort_parallel (NT)";
+    else if (AlgorithmId == Algorithm::ska_sort_copy_parallel_NT)
+        return "ska_sort_copy_parallel (NT)";
+    else if (AlgorithmId == Algorithm::ska_sort_Pdqsort)
+        return "ska_sort<Pdqsort>";
+    else if (AlgorithmId == Algorithm::ska_sort_Insertion)
+        return "ska_sort<Insertion>";
+    else if (AlgorithmId == Algorithm::ska_sort_Network)
+        return "ska_sort<Network>";
+    else if (AlgorithmId == Algorithm::ska_sort_L1)
+        return "ska_sort<L1>";
+    else if (AlgorithmId == Algorithm::ska_sort_L2)
+        return "ska_sort<L2>";
+    else if (AlgorithmId == Algorithm::jstdStringSort)
+        return "jstd::string_sort";
+    else if (AlgorithmId == Algorithm::jstdSortPermute)
+        return "jstd::sort_permute";
+    else if (AlgorithmId == Algorithm::stdPartialSort)
+        return "std::partial_sort";
+    else if (AlgorithmId == Algorithm::jstdPartialSort)
+        return "jstd::partial_sort";
+    else if (AlgorithmId == Algorithm::stdNthElement)
+        return "std::nth_element";
+    else if (AlgorithmId == Algorithm::jstdNthElement)
+        return "jstd::nth_element";
+    else if (AlgorithmId == Algorithm::jstdTopK)
+        return "jstd::top_k";
+    else if (AlgorithmId == Algorithm::stdMerge)
+        return "std::merge";
+    else if (AlgorithmId == Algorithm::stdPriorityQueueMerge)
+        return "std::priority_queue";
+    else if (AlgorithmId == Algorithm::jstdMergeK)
+        return "jstd::merge_k";
+    else if (AlgorithmId == Algorithm::jstdMergeKBranchless)
+        return "jstd::merge_k (branchless)";
+    else if (AlgorithmId == Algorithm::stdInplaceMerge)
+        return "std::inplace_merge";
+    else if (AlgorithmId == Algorithm::jstdSortedInsertBatch)
+        return "jstd::sorted_insert_batch";
+    else if (AlgorithmId == Algorithm::jstdSentinelInsertSort)
+        return "jstd::sentinel_insert_sort";
+    else if (AlgorithmId == Algorithm::jstdPairInsertSort)
+        return "jstd::pair_insert_sort";
+    else if (AlgorithmId == Algorithm::jstdHistogramSortSentinel)
+        return "histogram_sort<Sentinel>";
+    else if (AlgorithmId == Algorithm::jstdHistogramSortPair)
+        return "histogram_sort<Pair>";
+    else if (AlgorithmId == Algorithm::sgiIntroSortSentinel)
+        return "sgi::intro_sort<Sentinel>";
+    else if (AlgorithmId == Algorithm::sgiIntroSortPair)
+        return "sgi::intro_sort<Pair>";
+    else if (AlgorithmId == Algorithm::jstdQuadSmallSort)
+        return "jstd::quad_small_sort";
+    else if (AlgorithmId == Algorithm::jstdHistogramSortQuad)
+        return "histogram_sort<Quad>";
+    else if (AlgorithmId == Algorithm::sgiIntroSortQuad)
+        return "sgi::intro_sort<Quad>";
+    else if (AlgorithmId == Algorithm::ska_sort_Quad)
+        return "ska_sort<Quad>";
+    else if (AlgorithmId == Algorithm::jstdHistogramSortReverse)
+        return "histogram_sort + reverse";
+    else if (AlgorithmId == Algorithm::jstdHistogramSortDescending)
+        return "histogram_sort (greater)";
     else
         return "Unknown Algorithm";
 }
 
+//
+// The thread pools of the parallel sorts, created once (0 is all the hardware threads).
+//
+template <size_t AlgorithmId>
+jstd::TaskPool & getParallelTaskPool()
+{
+    static jstd::TaskPool s_task_pool(
+        (AlgorithmId == Algorithm::jstdParallelSort_1T) ? 1 :
+        (AlgorithmId == Algorithm::jstdParallelSort_2T) ? 2 :
+        (AlgorithmId == Algorithm::jstdParallelSort_4T) ? 4 :
+        (AlgorithmId == Algorithm::jstdParallelSort_8T) ? 8 : 0);
+    return s_task_pool;
+}
+
 inline uint16_t rand16()
 {
     return ((uint16_t)(rand() & 0x0000FFFFu));
@@ -321,6 +456,12 @@ void sort_algo_bench(const std::unique_ptr<std::vector<T>[]> & src_array_list,
             jstd::select_sort(test_array.begin(), test_array.end());
         } else if (AlgorithmId == Algorithm::jstdInsertSort) {
             jstd::insert_sort(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::jstdSentinelInsertSort) {
+            jstd::sentinel_insert_sort(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::jstdPairInsertSort) {
+            jstd::pair_insert_sort(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::jstdQuadSmallSort) {
+            jstd::quad_small_sort(test_array.begin(), test_array.end());
         } else if (AlgorithmId == Algorithm::jstdBinaryInsertSort) {
             jstd::binary_insert_sort(test_array.begin(), test_array.end());
         } else if (AlgorithmId == Algorithm::jstdBinaryInsertSort_v1) {
@@ -330,6 +471,12 @@ void sort_algo_bench(const std::unique_ptr<std::vector<T>[]> & src_array_list,
         } else if (AlgorithmId == Algorithm::jstdHistogramSort ||
                    AlgorithmId == Algorithm::jstdHistogramSortWide) {
             jstd::histogram_sort(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::jstdHistogramSortSentinel) {
+            jstd::histogram_sort_tuned<jstd::SentinelInsertSorter>(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::jstdHistogramSortPair) {
+            jstd::histogram_sort_tuned<jstd::PairInsertSorter>(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::jstdHistogramSortQuad) {
+            jstd::histogram_sort_tuned<jstd::QuadSmallSorter>(test_array.begin(), test_array.end());
         } else if (AlgorithmId == Algorithm::stdHeapSort) {
             std_heap_sort(test_array.begin(), test_array.end());
         } else if (AlgorithmId == Algorithm::stdStableSort) {
@@ -338,16 +485,58 @@ void sort_algo_bench(const std::unique_ptr<std::vector<T>[]> & src_array_list,
             std::sort(test_array.begin(), test_array.end());
         } else if (AlgorithmId == Algorithm::sgiIntroSort) {
             sgi::intro_sort(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::sgiIntroSortSentinel) {
+            sgi::intro_sort_tuned<jstd::SentinelInsertSorter>(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::sgiIntroSortPair) {
+            sgi::intro_sort_tuned<jstd::PairInsertSorter>(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::sgiIntroSortQuad) {
+            sgi::intro_sort_tuned<jstd::QuadSmallSorter>(test_array.begin(), test_array.end());
         } else if (AlgorithmId == Algorithm::orlp_pdqsort) {
             orlp::pdqsort(test_array.begin(), test_array.end());
         } else if (AlgorithmId == Algorithm::ska_sort ||
                    AlgorithmId == Algorithm::ska_sort_wide) {
             ska_sort(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::ska_sort_Pdqsort) {
+            ska_sort_tuned<ska_policy::Pdqsort>(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::ska_sort_Insertion) {
+            ska_sort_tuned<ska_policy::Insertion>(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::ska_sort_Network) {
+            ska_sort_tuned<ska_policy::Network>(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::ska_sort_Quad) {
+            ska_sort_tuned<ska_policy::Quad>(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::ska_sort_L1) {
+            ska_sort_tuned<ska_policy::L1>(test_array.begin(), test_array.end());
+        } else if (AlgorithmId == Algorithm::ska_sort_L2) {
+            ska_sort_tuned<ska_policy::L2>(test_array.begin(), test_array.end());
         } else if (AlgorithmId == Algorithm::ska_sort_copy ||
                    AlgorithmId == Algorithm::ska_sort_copy_wide) {
             size_t buff_size = test_array.size();
             std::unique_ptr<T[]> test_array_buff(new T[buff_size]);
-            ska_sort_copy(test_array.begin(), test_array.end(), &test_array_buff[0]);
+            bool in_buffer = ska_sort_copy(test_array.begin(), test_array.end(), &test_array_buff[0]);
+            if (in_buffer) {
+                std::copy(&test_array_buff[0], &test_array_buff[0] + buff_size, test_array.begin());
+            }
+        } else if (AlgorithmId == Algorithm::jstdParallelSort_1T ||
+                   AlgorithmId == Algorithm::jstdParallelSort_2T ||
+                   AlgorithmId == Algorithm::jstdParallelSort_4T ||
+                   AlgorithmId == Algorithm::jstdParallelSort_8T ||
+                   AlgorithmId == Algorithm::jstdParallelSort_NT) {
+            jstd::parallel_sort(test_array.begin(), test_array.end(),
+                                getParallelTaskPool<AlgorithmId>());
+        } else if (AlgorithmId == Algorithm::jstdParallelStableSort_NT) {
+            jstd::parallel_stable_sort(test_array.begin(), test_array.end(),
+                                       getParallelTaskPool<AlgorithmId>());
+        } else if (AlgorithmId == Algorithm::ska_sort_parallel_NT) {
+            ska_sort_parallel(test_array.begin(), test_array.end(),
+                              getParallelTaskPool<AlgorithmId>());
+        } else if (AlgorithmId == Algorithm::ska_sort_copy_parallel_NT) {
+            size_t buff_size = test_array.size();
+            std::unique_ptr<T[]> test_array_buff(new T[buff_size]);
+            bool in_buffer = ska_sort_copy_parallel(test_array.begin(), test_array.end(), &test_array_buff[0],
+                                                    getParallelTaskPool<AlgorithmId>());
+            if (in_buffer) {
+                std::copy(&test_array_buff[0], &test_array_buff[0] + buff_size, test_array.begin());
+            }
         }
     }
     sw.stop();
@@ -365,6 +554,59 @@ void sort_algo_bench(const std::unique_ptr<std::vector<T>[]> & src_array_list,
     printf("\n");
 }
 
+//
+// Sort all the arrays in one jstd::sort_batch() or jstd::segmented_sort() call,
+// the arrays are packed into a CSR-style buffer (offsets + data) before the timing starts.
+//
+template <size_t AlgorithmId, typename T>
+void csr_sort_algo_bench(const std::unique_ptr<std::vector<T>[]> & src_array_list,
+                         const std::unique_ptr<std::vector<T>[]> & standard_answers,
+                         size_t array_count, size_t total_items)
+{
+    test::StopWatch sw;
+    std::unique_ptr<std::vector<T>[]> test_array_list(new std::vector<T>[array_count]());
+
+    printf(" %-28s ", getSortAlgorithmName<AlgorithmId>());
+
+    // Pack src_array_list into offsets[] and data[]
+    std::vector<size_t> offsets;
+    std::vector<T> data;
+    offsets.reserve(array_count + 1);
+    data.reserve(total_items);
+    offsets.push_back(0);
+    for (size_t i = 0; i < array_count; i++) {
+        std::vector<T> & src_test_array = src_array_list[i];
+        data.insert(data.end(), src_test_array.begin(), src_test_array.end());
+        offsets.push_back(data.size());
+    }
+
+    sw.start();
+    if (AlgorithmId == Algorithm::jstdSortBatch) {
+        jstd::sort_batch(offsets.data(), data.data(), array_count);
+    } else if (AlgorithmId == Algorithm::jstdSegmentedSort) {
+        jstd::segmented_sort(data, offsets);
+    }
+    sw.stop();
+
+    // Unpack for verification
+    for (size_t i = 0; i < array_count; i++) {
+        std::vector<T> & test_array = test_array_list[i];
+        test_array.assign(data.begin() + offsets[i], data.begin() + offsets[i + 1]);
+    }
+
+    printf("Sort time: %8.3f ms", sw.getElapsedMillisec());
+    if (total_items != 0)
+        printf(", Per item time: %8.3f ns", sw.getElapsedNanosec() / total_items);
+    else
+        printf(", Per item time: N/A ns");
+
+    if (1) {
+        bool correctness = verify_sort_answers(test_array_list, standard_answers, array_count);
+        printf(", verify = %s", correctness ? "Pass" : "Failed");
+    }
+    printf("\n");
+}
+
 template <typename T, size_t ArrayType, size_t MinLen, size_t MaxLen>
 void sort_benchmark_impl()
 {
@@ -413,7 +655,9 @@ void sort_benchmark_impl()
         sort_algo_bench<Algorithm::jstdSelectSort, T>(TEST_PARAMS(test_array_list));
     }
     if (maxLen <= 256) {
-        sort_algo_bench<Algorithm::jstdInsertSort, T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::jstdInsertSort,         T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::jstdSentinelInsertSort, T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::jstdPairInsertSort,     T>(TEST_PARAMS(test_array_list));
     }
     if (maxLen <= 512) {
         sort_algo_bench<Algorithm::jstdBinaryInsertSort_v1, T>(TEST_PARAMS(test_array_list));
@@ -427,6 +671,8 @@ void sort_benchmark_impl()
 #ifdef _MSC_VER
     if (maxLen <= 1280) {
         sort_algo_bench<Algorithm::jstdInsertSort,          T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::jstdSentinelInsertSort,  T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::jstdPairInsertSort,      T>(TEST_PARAMS(test_array_list));
     }
     if (maxLen <= 2560) {
         sort_algo_bench<Algorithm::jstdBinaryInsertSort_v1, T>(TEST_PARAMS(test_array_list));
@@ -435,6 +681,8 @@ void sort_benchmark_impl()
 #else
     if (maxLen <= 2560) {
         sort_algo_bench<Algorithm::jstdInsertSort,          T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::jstdSentinelInsertSort,  T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::jstdPairInsertSort,      T>(TEST_PARAMS(test_array_list));
     }
     if (maxLen <= 5120) {
         sort_algo_bench<Algorithm::jstdBinaryInsertSort_v1, T>(TEST_PARAMS(test_array_list));
@@ -446,11 +694,40 @@ void sort_benchmark_impl()
     sort_algo_bench<Algorithm::stdHeapSort,       T>(TEST_PARAMS(test_array_list));
     sort_algo_bench<Algorithm::stdStableSort,     T>(TEST_PARAMS(test_array_list));
     sort_algo_bench<Algorithm::stdSort,           T>(TEST_PARAMS(test_array_list));
-    sort_algo_bench<Algorithm::sgiIntroSort,      T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::sgiIntroSort,         T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::sgiIntroSortSentinel, T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::sgiIntroSortPair,     T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::sgiIntroSortQuad,     T>(TEST_PARAMS(test_array_list));
     sort_algo_bench<Algorithm::orlp_pdqsort,      T>(TEST_PARAMS(test_array_list));
     sort_algo_bench<Algorithm::ska_sort,          T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::ska_sort_Pdqsort,   T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::ska_sort_Insertion, T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::ska_sort_Network,   T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::ska_sort_Quad,      T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::ska_sort_L1,        T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::ska_sort_L2,        T>(TEST_PARAMS(test_array_list));
     sort_algo_bench<Algorithm::ska_sort_copy,     T>(TEST_PARAMS(test_array_list));
-    sort_algo_bench<Algorithm::jstdHistogramSort, T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::jstdHistogramSort,         T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::jstdHistogramSortSentinel, T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::jstdHistogramSortPair,     T>(TEST_PARAMS(test_array_list));
+    sort_algo_bench<Algorithm::jstdHistogramSortQuad,     T>(TEST_PARAMS(test_array_list));
+    if (maxLen <= 256) {
+        sort_algo_bench<Algorithm::jstdQuadSmallSort,     T>(TEST_PARAMS(test_array_list));
+    }
+    if (maxLen <= 256) {
+        csr_sort_algo_bench<Algorithm::jstdSortBatch, T>(TEST_PARAMS(test_array_list));
+    }
+    csr_sort_algo_bench<Algorithm::jstdSegmentedSort, T>(TEST_PARAMS(test_array_list));
+    if (minLen >= 90000) {
+        sort_algo_bench<Algorithm::jstdParallelSort_1T,       T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::jstdParallelSort_2T,       T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::jstdParallelSort_4T,       T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::jstdParallelSort_8T,       T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::jstdParallelSort_NT,       T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::jstdParallelStableSort_NT, T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::ska_sort_parallel_NT,      T>(TEST_PARAMS(test_array_list));
+        sort_algo_bench<Algorithm::ska_sort_copy_parallel_NT, T>(TEST_PARAMS(test_array_list));
+    }
 
     // Test wide range random array
     for (size_t i = 0; i < array_count; i++) {
@@ -521,6 +798,947 @@ void sort_benchmark()
 #endif
 }
 
+struct StringKind {
+    enum {
+        Urls,
+        Paths,
+        Numbers,
+        Last
+    };
+};
+
+template <size_t StringType>
+const char * getStringKindName()
+{
+    if (StringType == StringKind::Urls)
+        return "Urls";
+    else if (StringType == StringKind::Paths)
+        return "Paths";
+    else if (StringType == StringKind::Numbers)
+        return "Numbers";
+    else
+        return "Unknown";
+}
+
+//
+// The Urls and Paths strings share long prefixes.
+//
+template <size_t StringType>
+std::string generate_test_string()
+{
+    static const char * const kSections[] = { "news", "products", "users", "search" };
+    char buf[256];
+    if (StringType == StringKind::Urls) {
+        snprintf(buf, sizeof(buf), "https://www.example.com/%s/%u/%u?id=%u",
+                 kSections[rand30() % 4], rand30() % 100, rand30() % 1000, rand30());
+    } else if (StringType == StringKind::Paths) {
+        snprintf(buf, sizeof(buf), "/usr/local/share/project/src/module_%u/component_%u/file_%u.cpp",
+                 rand30() % 16, rand30() % 64, rand30() % 100000);
+    } else {
+        snprintf(buf, sizeof(buf), "%u", rand32());
+    }
+    return std::string(buf);
+}
+
+template <size_t AlgorithmId>
+void string_sort_algo_bench(const std::vector<std::string> & src_strings,
+                            const std::vector<std::string> & answer)
+{
+    test::StopWatch sw;
+    std::vector<std::string> test_strings(src_strings);
+
+    printf(" %-28s ", getSortAlgorithmName<AlgorithmId>());
+
+    sw.start();
+    if (0) {
+        // Do nothing!!
+    } else if (AlgorithmId == Algorithm::stdSort) {
+        std::sort(test_strings.begin(), test_strings.end());
+    } else if (AlgorithmId == Algorithm::ska_sort) {
+        ska_sort(test_strings.begin(), test_strings.end());
+    } else if (AlgorithmId == Algorithm::jstdStringSort) {
+        jstd::string_sort(test_strings.begin(), test_strings.end());
+    }
+    sw.stop();
+
+    printf("Sort time: %8.3f ms", sw.getElapsedMillisec());
+    if (!test_strings.empty())
+        printf(", Per item time: %8.3f ns", sw.getElapsedNanosec() / test_strings.size());
+    else
+        printf(", Per item time: N/A ns");
+
+    if (1) {
+        bool correctness = (test_strings == answer);
+        printf(", verify = %s", correctness ? "Pass" : "Failed");
+    }
+    printf("\n");
+}
+
+template <size_t StringType>
+void string_sort_benchmark_impl(size_t count)
+{
+    std::vector<std::string> test_strings;
+    test_strings.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        test_strings.push_back(generate_test_string<StringType>());
+    }
+
+    std::vector<std::string> answer(test_strings);
+    std::sort(answer.begin(), answer.end());
+
+    printf(" string_sort_benchmark<%s>, count = %u\n\n",
+           getStringKindName<StringType>(), (uint32_t)count);
+
+    string_sort_algo_bench<Algorithm::stdSort>(test_strings, answer);
+    string_sort_algo_bench<Algorithm::ska_sort>(test_strings, answer);
+    string_sort_algo_bench<Algorithm::jstdStringSort>(test_strings, answer);
+
+    printf("\n");
+}
+
+void string_sort_benchmark()
+{
+    static const size_t kStringCount = kTotalArrayCount / 4;
+
+    string_sort_benchmark_impl<StringKind::Urls>(kStringCount);
+    string_sort_benchmark_impl<StringKind::Paths>(kStringCount);
+    string_sort_benchmark_impl<StringKind::Numbers>(kStringCount);
+}
+
+//
+// A heavyweight record, like a row of a column-store, sorted by its key.
+//
+template <size_t Size>
+struct FatRecord {
+    uint32_t key;
+    uint32_t payload[Size / sizeof(uint32_t) - 1];
+
+    bool operator == (const FatRecord & rhs) const {
+        return (this->key == rhs.key) && (this->payload[0] == rhs.payload[0]);
+    }
+};
+
+template <size_t AlgorithmId, size_t Size>
+void fat_record_sort_algo_bench(const std::vector<FatRecord<Size>> & src_records,
+                                const std::vector<FatRecord<Size>> & answer)
+{
+    typedef FatRecord<Size> record_type;
+
+    test::StopWatch sw;
+    std::vector<record_type> test_records(src_records);
+
+    printf(" %-28s ", getSortAlgorithmName<AlgorithmId>());
+
+    sw.start();
+    if (0) {
+        // Do nothing!!
+    } else if (AlgorithmId == Algorithm::stdStableSort) {
+        std::stable_sort(test_records.begin(), test_records.end(),
+                         [](const record_type & a, const record_type & b) { return (a.key < b.key); });
+    } else if (AlgorithmId == Algorithm::orlp_pdqsort) {
+        orlp::pdqsort(test_records.begin(), test_records.end(),
+                      [](const record_type & a, const record_type & b) { return (a.key < b.key); });
+    } else if (AlgorithmId == Algorithm::ska_sort) {
+        ska_sort(test_records.begin(), test_records.end(),
+                 [](const record_type & record) { return record.key; });
+    } else if (AlgorithmId == Algorithm::jstdSortPermute) {
+        jstd::sort_permute(test_records.begin(), test_records.end(),
+                           [](const record_type & record) { return record.key; });
+    }
+    sw.stop();
+
+    printf("Sort time: %8.3f ms", sw.getElapsedMillisec());
+    if (!test_records.empty())
+        printf(", Per item time: %8.3f ns", sw.getElapsedNanosec() / test_records.size());
+    else
+        printf(", Per item time: N/A ns");
+
+    if (1) {
+        bool correctness = (test_records == answer);
+        printf(", verify = %s", correctness ? "Pass" : "Failed");
+    }
+    printf("\n");
+}
+
+//
+// The keys are unique, so all the algorithms have the same answer,
+// and sparse (a multiplicative hash of the index), so they need a radix or comparison sort.
+//
+template <size_t Size>
+void fat_record_benchmark_impl(size_t count)
+{
+    typedef FatRecord<Size> record_type;
+
+    std::vector<record_type> test_records(count);
+    for (size_t i = 0; i < count; i++) {
+        test_records[i].key = static_cast<uint32_t>(i * 2654435761ull);
+        for (size_t n = 0; n < sizeof(test_records[i].payload) / sizeof(uint32_t); n++) {
+            test_records[i].payload[n] = static_cast<uint32_t>(i + n);
+        }
+    }
+    for (size_t i = count - 1; i > 0; i--) {
+        size_t pos = static_cast<size_t>(rand30()) % (i + 1);
+        std::swap(test_records[i], test_records[pos]);
+    }
+
+    std::vector<record_type> answer(test_records);
+    std::sort(answer.begin(), answer.end(),
+              [](const record_type & a, const record_type & b) { return (a.key < b.key); });
+
+    printf(" fat_record_benchmark<%u bytes>, count = %u\n\n",
+           (uint32_t)sizeof(record_type), (uint32_t)count);
+
+    fat_record_sort_algo_bench<Algorithm::stdStableSort, Size>(test_records, answer);
+    fat_record_sort_algo_bench<Algorithm::orlp_pdqsort,  Size>(test_records, answer);
+    fat_record_sort_algo_bench<Algorithm::ska_sort,      Size>(test_records, answer);
+    fat_record_sort_algo_bench<Algorithm::jstdSortPermute, Size>(test_records, answer);
+
+    printf("\n");
+}
+
+void fat_record_benchmark()
+{
+    static const size_t kRecordCount = kTotalArrayCount / 32;
+
+    fat_record_benchmark_impl<64>(kRecordCount);
+    fat_record_benchmark_impl<128>(kRecordCount);
+    fat_record_benchmark_impl<256>(kRecordCount);
+    fat_record_benchmark_impl<512>(kRecordCount);
+}
+
+template <size_t AlgorithmId, typename T>
+void partial_sort_algo_bench(const std::vector<T> & src_array, const std::vector<T> & answer, size_t k)
+{
+    test::StopWatch sw;
+    std::vector<T> test_array(src_array);
+    std::vector<T> top_k_array(k);
+
+    printf(" %-28s ", getSortAlgorithmName<AlgorithmId>());
+
+    sw.start();
+    if (0) {
+        // Do nothing!!
+    } else if (AlgorithmId == Algorithm::stdPartialSort) {
+        std::partial_sort(test_array.begin(), test_array.begin() + k, test_array.end());
+    } else if (AlgorithmId == Algorithm::jstdPartialSort) {
+        jstd::partial_sort(test_array.begin(), test_array.begin() + k, test_array.end());
+    } else if (AlgorithmId == Algorithm::stdNthElement) {
+        std::nth_element(test_array.begin(), test_array.begin() + (k - 1), test_array.end());
+    } else if (AlgorithmId == Algorithm::jstdNthElement) {
+        jstd::nth_element(test_array.begin(), test_array.begin() + (k - 1), test_array.end());
+    } else if (AlgorithmId == Algorithm::jstdTopK) {
+        jstd::top_k(test_array.begin(), test_array.end(), k, top_k_array.begin());
+    }
+    sw.stop();
+
+    printf("Sort time: %8.3f ms", sw.getElapsedMillisec());
+    if (!test_array.empty())
+        printf(", Per item time: %8.3f ns", sw.getElapsedNanosec() / test_array.size());
+    else
+        printf(", Per item time: N/A ns");
+
+    if (1) {
+        bool correctness;
+        if (AlgorithmId == Algorithm::stdNthElement || AlgorithmId == Algorithm::jstdNthElement)
+            correctness = (test_array[k - 1] == answer[k - 1]);
+        else if (AlgorithmId == Algorithm::jstdTopK)
+            correctness = std::equal(top_k_array.begin(), top_k_array.end(), answer.begin());
+        else
+            correctness = std::equal(test_array.begin(), test_array.begin() + k, answer.begin());
+        printf(", verify = %s", correctness ? "Pass" : "Failed");
+    }
+    printf("\n");
+}
+
+template <typename T>
+void partial_sort_benchmark_impl(const std::vector<T> & test_array, const std::vector<T> & answer, size_t k)
+{
+    printf(" partial_sort_benchmark, length = %u, k = %u\n\n",
+           (uint32_t)test_array.size(), (uint32_t)k);
+
+    partial_sort_algo_bench<Algorithm::stdPartialSort,  T>(test_array, answer, k);
+    partial_sort_algo_bench<Algorithm::jstdPartialSort, T>(test_array, answer, k);
+    partial_sort_algo_bench<Algorithm::stdNthElement,   T>(test_array, answer, k);
+    partial_sort_algo_bench<Algorithm::jstdNthElement,  T>(test_array, answer, k);
+    partial_sort_algo_bench<Algorithm::jstdTopK,        T>(test_array, answer, k);
+
+    printf("\n");
+}
+
+//
+// Top-K of k = 10, 100, 1% and 10%.
+//
+void partial_sort_benchmark()
+{
+    static const size_t kLength = kTotalArrayCount / 4;
+
+    std::vector<uint32_t> test_array(kLength);
+    for (size_t i = 0; i < kLength; i++) {
+        test_array[i] = rand32();
+    }
+
+    std::vector<uint32_t> answer(test_array);
+    std::sort(answer.begin(), answer.end());
+
+    partial_sort_benchmark_impl(test_array, answer, 10);
+    partial_sort_benchmark_impl(test_array, answer, 100);
+    partial_sort_benchmark_impl(test_array, answer, kLength / 100);
+    partial_sort_benchmark_impl(test_array, answer, kLength / 10);
+}
+
+//
+// Merge the k runs by std::merge(), pairwise in log2(k) passes.
+//
+template <typename T>
+void std_merge_cascade(const std::vector<T> & src_array, size_t k, std::vector<T> & output)
+{
+    size_t length = src_array.size();
+    std::vector<T> buffer(src_array);
+    std::vector<size_t> bounds(k + 1);
+    for (size_t i = 0; i <= k; i++) {
+        bounds[i] = length * i / k;
+    }
+    while (bounds.size() > 2) {
+        std::vector<size_t> merged_bounds;
+        for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+            merged_bounds.push_back(bounds[i]);
+            if (i + 2 < bounds.size()) {
+                std::merge(buffer.begin() + bounds[i],     buffer.begin() + bounds[i + 1],
+                           buffer.begin() + bounds[i + 1], buffer.begin() + bounds[i + 2],
+                           output.begin() + bounds[i]);
+            } else {
+                std::copy(buffer.begin() + bounds[i], buffer.begin() + bounds[i + 1],
+                          output.begin() + bounds[i]);
+            }
+        }
+        merged_bounds.push_back(length);
+        bounds.swap(merged_bounds);
+        buffer.swap(output);
+    }
+    buffer.swap(output);
+}
+
+template <typename T>
+void std_priority_queue_merge(const std::vector<T> & src_array, size_t k, std::vector<T> & output)
+{
+    typedef std::pair<T, size_t> entry_type;
+
+    size_t length = src_array.size();
+    std::vector<size_t> cursors(k), lasts(k);
+    std::priority_queue<entry_type, std::vector<entry_type>, std::greater<entry_type>> heap;
+    for (size_t i = 0; i < k; i++) {
+        cursors[i] = length * i / k;
+        lasts[i] = length * (i + 1) / k;
+        if (cursors[i] != lasts[i])
+            heap.push(entry_type(src_array[cursors[i]], i));
+    }
+    size_t pos = 0;
+    while (!heap.empty()) {
+        entry_type top = heap.top();
+        heap.pop();
+        output[pos++] = top.first;
+        size_t run = top.second;
+        if (++cursors[run] != lasts[run])
+            heap.push(entry_type(src_array[cursors[run]], run));
+    }
+}
+
+template <size_t AlgorithmId, typename T>
+void merge_algo_bench(const std::vector<T> & src_array, const std::vector<T> & answer, size_t k)
+{
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    test::StopWatch sw;
+    size_t length = src_array.size();
+    std::vector<T> output(length);
+    std::vector<std::pair<const_iterator, const_iterator>> runs;
+    for (size_t i = 0; i < k; i++) {
+        runs.push_back(std::make_pair(src_array.begin() + length * i / k,
+                                      src_array.begin() + length * (i + 1) / k));
+    }
+
+    printf(" %-28s ", getSortAlgorithmName<AlgorithmId>());
+
+    sw.start();
+    if (0) {
+        // Do nothing!!
+    } else if (AlgorithmId == Algorithm::stdMerge) {
+        std_merge_cascade(src_array, k, output);
+    } else if (AlgorithmId == Algorithm::stdPriorityQueueMerge) {
+        std_priority_queue_merge(src_array, k, output);
+    } else if (AlgorithmId == Algorithm::jstdMergeK) {
+        jstd::merge_k(runs, output.begin());
+    } else if (AlgorithmId == Algorithm::jstdMergeKBranchless) {
+        // Not std::less<T>, no bitonic merge kernel.
+        jstd::merge_k(runs, output.begin(), [](const T & a, const T & b) { return (a < b); });
+    }
+    sw.stop();
+
+    printf("Merge time: %8.3f ms", sw.getElapsedMillisec());
+    if (!output.empty())
+        printf(", Per item time: %8.3f ns", sw.getElapsedNanosec() / output.size());
+    else
+        printf(", Per item time: N/A ns");
+
+    if (1) {
+        bool correctness = (output == answer);
+        printf(", verify = %s", correctness ? "Pass" : "Failed");
+    }
+    printf("\n");
+}
+
+//
+// The k-way merge of k = 2 .. 1024 sorted runs of random uint32_t.
+//
+void merge_benchmark()
+{
+    static const size_t kLength = kTotalArrayCount / 4;
+
+    std::vector<uint32_t> answer(kLength);
+    for (size_t i = 0; i < kLength; i++) {
+        answer[i] = rand32();
+    }
+
+    std::vector<uint32_t> src_array(answer);
+    std::sort(answer.begin(), answer.end());
+
+    static const size_t kRuns[] = { 2, 4, 16, 64, 256, 1024 };
+
+    for (size_t n = 0; n < sizeof(kRuns) / sizeof(kRuns[0]); n++) {
+        size_t k = kRuns[n];
+        std::vector<uint32_t> test_array(src_array);
+        for (size_t i = 0; i < k; i++) {
+            std::sort(test_array.begin() + kLength * i / k, test_array.begin() + kLength * (i + 1) / k);
+        }
+
+        printf(" merge_benchmark, length = %u, k = %u, kernel = %s\n\n",
+               (uint32_t)kLength, (uint32_t)k, jstd::merge_kernel_name());
+
+        merge_algo_bench<Algorithm::stdMerge,              uint32_t>(test_array, answer, k);
+        merge_algo_bench<Algorithm::stdPriorityQueueMerge, uint32_t>(test_array, answer, k);
+        merge_algo_bench<Algorithm::jstdMergeK,            uint32_t>(test_array, answer, k);
+        merge_algo_bench<Algorithm::jstdMergeKBranchless,  uint32_t>(test_array, answer, k);
+
+        printf("\n");
+    }
+}
+
+template <size_t AlgorithmId, typename T>
+void sorted_insert_algo_bench(const std::vector<T> & initial, const std::vector<T> & stream,
+                              size_t batch_size, const std::vector<T> & answer)
+{
+    test::StopWatch sw;
+    std::vector<T> sorted(initial);
+    sorted.reserve(answer.size());
+
+    printf(" %-28s ", getSortAlgorithmName<AlgorithmId>());
+
+    sw.start();
+    for (size_t pos = 0; pos < stream.size(); pos += batch_size) {
+        if (0) {
+            // Do nothing!!
+        } else if (AlgorithmId == Algorithm::stdSort) {
+            sorted.insert(sorted.end(), stream.begin() + pos, stream.begin() + pos + batch_size);
+            std::sort(sorted.begin(), sorted.end());
+        } else if (AlgorithmId == Algorithm::jstdHistogramSort) {
+            sorted.insert(sorted.end(), stream.begin() + pos, stream.begin() + pos + batch_size);
+            jstd::histogram_sort(sorted.begin(), sorted.end());
+        } else if (AlgorithmId == Algorithm::stdInplaceMerge) {
+            size_t old_size = sorted.size();
+            sorted.insert(sorted.end(), stream.begin() + pos, stream.begin() + pos + batch_size);
+            std::sort(sorted.begin() + old_size, sorted.end());
+            std::inplace_merge(sorted.begin(), sorted.begin() + old_size, sorted.end());
+        } else if (AlgorithmId == Algorithm::jstdSortedInsertBatch) {
+            jstd::sorted_insert_batch(sorted, stream.begin() + pos, stream.begin() + pos + batch_size);
+        }
+    }
+    sw.stop();
+
+    size_t batches = stream.size() / batch_size;
+    printf("Total time: %8.3f ms, Per batch time: %8.3f us",
+           sw.getElapsedMillisec(), sw.getElapsedMillisec() * 1000.0 / batches);
+
+    if (1) {
+        bool correctness = (sorted == answer);
+        printf(", verify = %s", correctness ? "Pass" : "Failed");
+    }
+    printf("\n");
+}
+
+//
+// A stream of the append batches of random uint32_t into a sorted array.
+//
+void sorted_insert_benchmark()
+{
+    static const size_t kInitialLength = kTotalArrayCount / 64;
+    static const size_t kBatchCount = 128;
+    static const size_t kBatchSizes[] = { 1, 16, 256, 2048 };
+
+    std::vector<uint32_t> initial(kInitialLength);
+    for (size_t i = 0; i < kInitialLength; i++) {
+        initial[i] = rand32();
+    }
+    std::sort(initial.begin(), initial.end());
+
+    for (size_t n = 0; n < sizeof(kBatchSizes) / sizeof(kBatchSizes[0]); n++) {
+        size_t batch_size = kBatchSizes[n];
+        std::vector<uint32_t> stream(batch_size * kBatchCount);
+        for (size_t i = 0; i < stream.size(); i++) {
+            stream[i] = rand32();
+        }
+
+        std::vector<uint32_t> answer(initial);
+        answer.insert(answer.end(), stream.begin(), stream.end());
+        std::sort(answer.begin(), answer.end());
+
+        printf(" sorted_insert_benchmark, initial = %u, batch_size = %u, batches = %u\n\n",
+               (uint32_t)kInitialLength, (uint32_t)batch_size, (uint32_t)kBatchCount);
+
+        sorted_insert_algo_bench<Algorithm::stdSort,               uint32_t>(initial, stream, batch_size, answer);
+        sorted_insert_algo_bench<Algorithm::jstdHistogramSort,     uint32_t>(initial, stream, batch_size, answer);
+        sorted_insert_algo_bench<Algorithm::stdInplaceMerge,       uint32_t>(initial, stream, batch_size, answer);
+        sorted_insert_algo_bench<Algorithm::jstdSortedInsertBatch, uint32_t>(initial, stream, batch_size, answer);
+
+        printf("\n");
+    }
+}
+
+template <size_t AlgorithmId, typename T>
+void descending_sort_algo_bench(const std::vector<T> & src_array, const std::vector<T> & answer)
+{
+    test::StopWatch sw;
+    std::vector<T> test_array(src_array);
+
+    printf(" %-28s ", getSortAlgorithmName<AlgorithmId>());
+
+    sw.start();
+    if (0) {
+        // Do nothing!!
+    } else if (AlgorithmId == Algorithm::stdSort) {
+        std::sort(test_array.begin(), test_array.end(), std::greater<T>());
+    } else if (AlgorithmId == Algorithm::jstdHistogramSortReverse) {
+        jstd::histogram_sort(test_array.begin(), test_array.end());
+        std::reverse(test_array.begin(), test_array.end());
+    } else if (AlgorithmId == Algorithm::jstdHistogramSortDescending) {
+        jstd::histogram_sort(test_array.begin(), test_array.end(), std::greater<T>());
+    }
+    sw.stop();
+
+    printf("Sort time: %8.3f ms", sw.getElapsedMillisec());
+    printf(", Per item time: %8.3f ns", sw.getElapsedNanosec() / src_array.size());
+
+    if (1) {
+        bool correctness = (test_array == answer);
+        printf(", verify = %s", correctness ? "Pass" : "Failed");
+    }
+    printf("\n");
+}
+
+//
+// The descending sort of the scores, by the order of the comparer or by a second pass.
+//
+void descending_sort_benchmark()
+{
+    static const size_t kLength = kTotalArrayCount;
+    static const uint32_t kScoreRanges[] = { 65536, 1024 * 1024, 1u << 30 };
+
+    for (size_t n = 0; n < sizeof(kScoreRanges) / sizeof(kScoreRanges[0]); n++) {
+        uint32_t range = kScoreRanges[n];
+        std::vector<uint32_t> src_array(kLength);
+        for (size_t i = 0; i < kLength; i++) {
+            src_array[i] = rand32() % range;
+        }
+        std::vector<uint32_t> answer(src_array);
+        std::sort(answer.begin(), answer.end(), std::greater<uint32_t>());
+
+        printf(" descending_sort_benchmark, length = %u, range = %u\n\n",
+               (uint32_t)kLength, range);
+
+        descending_sort_algo_bench<Algorithm::stdSort,                     uint32_t>(src_array, answer);
+        descending_sort_algo_bench<Algorithm::jstdHistogramSortReverse,    uint32_t>(src_array, answer);
+        descending_sort_algo_bench<Algorithm::jstdHistogramSortDescending, uint32_t>(src_array, answer);
+
+        printf("\n");
+    }
+}
+
+template <size_t AlgorithmId, typename T>
+void skewed_sort_algo_bench(const std::vector<T> & src_array, const std::vector<T> & answer)
+{
+    test::StopWatch sw;
+    std::vector<T> test_array(src_array);
+
+    printf(" %-28s ", getSortAlgorithmName<AlgorithmId>());
+
+    sw.start();
+    if (0) {
+        // Do nothing!!
+    } else if (AlgorithmId == Algorithm::stdSort) {
+        std::sort(test_array.begin(), test_array.end());
+    } else if (AlgorithmId == Algorithm::jstdHistogramSort) {
+        jstd::histogram_sort(test_array.begin(), test_array.end());
+    } else if (AlgorithmId == Algorithm::ska_sort) {
+        ska_sort(test_array.begin(), test_array.end());
+    }
+    sw.stop();
+
+    printf("Sort time: %8.3f ms", sw.getElapsedMillisec());
+    printf(", Per item time: %8.3f ns", sw.getElapsedNanosec() / src_array.size());
+
+    if (1) {
+        bool correctness = (test_array == answer);
+        printf(", verify = %s", correctness ? "Pass" : "Failed");
+    }
+    printf("\n");
+}
+
+//
+// The skewed keys crowd a few buckets of proxmap_sort().
+//
+void skewed_sort_benchmark()
+{
+    static const size_t kLength = kTotalArrayCount;
+    static const char * kSkewNames[] = { "90% in a narrow range", "16 clusters", "power law" };
+
+    for (size_t n = 0; n < sizeof(kSkewNames) / sizeof(kSkewNames[0]); n++) {
+        std::vector<uint32_t> src_array(kLength);
+        for (size_t i = 0; i < kLength; i++) {
+            if (n == 0) {
+                src_array[i] = ((rand32() % 10) < 9) ? (rand32() % 100000) : rand32();
+            } else if (n == 1) {
+                src_array[i] = ((rand32() % 16) << 28) | (rand32() % 65536);
+            } else {
+                uint64_t value = rand32();
+                value = (value * rand32()) >> 32;
+                value = (value * rand32()) >> 32;
+                src_array[i] = static_cast<uint32_t>((value * rand32()) >> 32);
+            }
+        }
+        std::vector<uint32_t> answer(src_array);
+        std::sort(answer.begin(), answer.end());
+
+        printf(" skewed_sort_benchmark, length = %u, keys = %s\n\n",
+               (uint32_t)kLength, kSkewNames[n]);
+
+        skewed_sort_algo_bench<Algorithm::stdSort,           uint32_t>(src_array, answer);
+        skewed_sort_algo_bench<Algorithm::ska_sort,          uint32_t>(src_array, answer);
+        skewed_sort_algo_bench<Algorithm::jstdHistogramSort, uint32_t>(src_array, answer);
+
+        printf("\n");
+    }
+}
+
+//
+// Write a file of total_records random uint32_t.
+//
+bool generate_random_file(const char * path, uint64_t total_records)
+{
+    typedef uint32_t value_type;
+
+    static const size_t kBlockRecords = 1024 * 1024;
+
+    FILE * file = fopen(path, "wb");
+    if (file == nullptr)
+        return false;
+
+    std::vector<value_type> block(kBlockRecords);
+    bool success = true;
+    for (uint64_t written = 0; written < total_records; ) {
+        size_t count = (size_t)std::min<uint64_t>(kBlockRecords, total_records - written);
+        for (size_t i = 0; i < count; i++) {
+            block[i] = rand32();
+        }
+        success = success && (fwrite(block.data(), sizeof(value_type), count, file) == count);
+        written += count;
+    }
+    return (fclose(file) == 0) && success;
+}
+
+//
+// Verify the file of uint32_t is sorted and has total_records records.
+//
+bool verify_sorted_file(const char * path, uint64_t total_records)
+{
+    typedef uint32_t value_type;
+
+    static const size_t kBlockRecords = 1024 * 1024;
+
+    FILE * file = fopen(path, "rb");
+    if (file == nullptr)
+        return false;
+
+    std::vector<value_type> block(kBlockRecords);
+    bool correctness = true;
+    uint64_t read_records = 0;
+    value_type last = 0;
+    size_t count;
+    while ((count = fread(block.data(), sizeof(value_type), kBlockRecords, file)) != 0) {
+        for (size_t i = 0; i < count; i++) {
+            correctness = correctness && (block[i] >= last);
+            last = block[i];
+        }
+        read_records += count;
+    }
+    fclose(file);
+    return correctness && (read_records == total_records);
+}
+
+//
+// SortBench --external-sort [size_mb [memory_mb]]
+//
+// Sort a generated file of random uint32_t by jstd::external_sort(),
+// report the throughput of each phase.
+//
+void external_sort_benchmark(size_t size_mb, size_t memory_mb)
+{
+    typedef uint32_t value_type;
+
+    static const char * kInputPath  = "sortbench_external.in";
+    static const char * kOutputPath = "sortbench_external.out";
+
+    const double kGB = 1024.0 * 1024.0 * 1024.0;
+
+    uint64_t total_records = uint64_t(size_mb) * 1024 * 1024 / sizeof(value_type);
+
+    printf(" external_sort_benchmark, size = %u MB, memory = %u MB\n\n",
+           (uint32_t)size_mb, (uint32_t)memory_mb);
+
+    test::StopWatch sw;
+    sw.start();
+    if (!generate_random_file(kInputPath, total_records)) {
+        printf(" Can't create the file: %s\n\n", kInputPath);
+        return;
+    }
+    sw.stop();
+
+    double total_gb = double(total_records * sizeof(value_type)) / kGB;
+    printf(" %-28s time: %10.3f ms, %8.3f GB/s\n", "generate",
+           sw.getElapsedMillisec(), total_gb / sw.getElapsedSecond());
+
+    jstd::ExternalSortOptions options;
+    options.memory_bytes = memory_mb * 1024 * 1024;
+    jstd::ExternalSortStats stats;
+    bool success = jstd::external_sort<value_type>(kInputPath, kOutputPath, options, &stats);
+
+    double bytes_gb = double(stats.bytes) / kGB;
+    printf(" %-28s time: %10.3f ms, %8.3f GB/s, runs = %u\n", "run generation",
+           stats.run_seconds * 1000.0, bytes_gb / stats.run_seconds, (uint32_t)stats.runs);
+    printf(" %-28s time: %10.3f ms, %8.3f GB/s, passes = %u\n", "merge",
+           stats.merge_seconds * 1000.0, bytes_gb * stats.merge_passes / stats.merge_seconds,
+           (uint32_t)stats.merge_passes);
+    printf(" %-28s time: %10.3f ms, %8.3f GB/s\n", "external_sort",
+           (stats.run_seconds + stats.merge_seconds) * 1000.0,
+           bytes_gb / (stats.run_seconds + stats.merge_seconds));
+
+    // Verify the output is sorted and has all the records.
+    bool correctness = success && verify_sorted_file(kOutputPath, total_records);
+    printf(" verify = %s\n\n", correctness ? "Pass" : "Failed");
+
+    remove(kInputPath);
+    remove(kOutputPath);
+}
+
+//
+// SortBench --mmap-sort [size_mb]
+//
+// Sort a generated file of random uint32_t, which fits in the memory:
+// read into a std::vector + ska_sort() + write, versus jstd::mmap_sort()
+// and jstd::mmap_histogram_sort() into the output file and in place.
+//
+void mmap_sort_benchmark(size_t size_mb)
+{
+    typedef uint32_t value_type;
+
+    static const char * kInputPath  = "sortbench_mmap.in";
+    static const char * kOutputPath = "sortbench_mmap.out";
+
+    const double kGB = 1024.0 * 1024.0 * 1024.0;
+
+    uint64_t total_records = uint64_t(size_mb) * 1024 * 1024 / sizeof(value_type);
+    double total_gb = double(total_records * sizeof(value_type)) / kGB;
+
+    printf(" mmap_sort_benchmark, size = %u MB\n\n", (uint32_t)size_mb);
+
+    if (!generate_random_file(kInputPath, total_records)) {
+        printf(" Can't create the file: %s\n\n", kInputPath);
+        return;
+    }
+
+    test::StopWatch sw;
+    bool success;
+
+    // read() + ska_sort() + write(), the input file is not changed.
+    {
+        sw.start();
+        std::vector<value_type> records((size_t)total_records);
+        success = false;
+        FILE * file = fopen(kInputPath, "rb");
+        if (file != nullptr) {
+            success = (fread(records.data(), sizeof(value_type), records.size(), file) == records.size());
+            fclose(file);
+        }
+        ska_sort(records.begin(), records.end());
+        file = fopen(kOutputPath, "wb");
+        if (file != nullptr) {
+            success = success && (fwrite(records.data(), sizeof(value_type), records.size(), file) == records.size());
+            success = (fclose(file) == 0) && success;
+        }
+        sw.stop();
+
+        bool correctness = success && verify_sorted_file(kOutputPath, total_records);
+        printf(" %-28s time: %10.3f ms, %8.3f GB/s, verify = %s\n", "read + ska_sort + write",
+               sw.getElapsedMillisec(), total_gb / sw.getElapsedSecond(),
+               correctness ? "Pass" : "Failed");
+        remove(kOutputPath);
+    }
+
+    // The input is copied to the output file, which is sorted in place.
+    {
+        sw.start();
+        success = jstd::mmap_sort<value_type>(kInputPath, kOutputPath);
+        sw.stop();
+
+        bool correctness = success && verify_sorted_file(kOutputPath, total_records);
+        printf(" %-28s time: %10.3f ms, %8.3f GB/s, verify = %s\n", "jstd::mmap_sort (copy)",
+               sw.getElapsedMillisec(), total_gb / sw.getElapsedSecond(),
+               correctness ? "Pass" : "Failed");
+        remove(kOutputPath);
+    }
+
+    {
+        sw.start();
+        success = jstd::mmap_histogram_sort<value_type>(kInputPath, kOutputPath);
+        sw.stop();
+
+        bool correctness = success && verify_sorted_file(kOutputPath, total_records);
+        printf(" %-28s time: %10.3f ms, %8.3f GB/s, verify = %s\n", "jstd::mmap_histogram_sort",
+               sw.getElapsedMillisec(), total_gb / sw.getElapsedSecond(),
+               correctness ? "Pass" : "Failed");
+        remove(kOutputPath);
+    }
+
+    // In place, the last one, it changes the input file.
+    {
+        sw.start();
+        success = jstd::mmap_sort<value_type>(kInputPath);
+        sw.stop();
+
+        bool correctness = success && verify_sorted_file(kInputPath, total_records);
+        printf(" %-28s time: %10.3f ms, %8.3f GB/s, verify = %s\n", "jstd::mmap_sort (in place)",
+               sw.getElapsedMillisec(), total_gb / sw.getElapsedSecond(),
+               correctness ? "Pass" : "Failed");
+    }
+    printf("\n");
+
+    remove(kInputPath);
+}
+
+//
+// The array of huge_sort_benchmark(): mmap() with the transparent huge pages hint
+// (MADV_HUGEPAGE) on Linux, VirtualAlloc() on Windows, the pages are touched by the caller.
+//
+template <typename T>
+class HugePageArray {
+private:
+    T *     data_;
+    size_t  size_;
+    size_t  bytes_;
+
+public:
+    explicit HugePageArray(size_t size) : data_(nullptr), size_(size), bytes_(size * sizeof(T)) {
+#if defined(_WIN32) || defined(_WIN64)
+        data_ = static_cast<T *>(::VirtualAlloc(nullptr, bytes_, MEM_RESERVE | MEM_COMMIT,
+                                                PAGE_READWRITE));
+#else
+        void * ptr = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr != MAP_FAILED) {
+#if defined(MADV_HUGEPAGE)
+            ::madvise(ptr, bytes_, MADV_HUGEPAGE);
+#endif
+            data_ = static_cast<T *>(ptr);
+        }
+#endif
+    }
+
+    ~HugePageArray() {
+        if (data_ != nullptr) {
+#if defined(_WIN32) || defined(_WIN64)
+            ::VirtualFree(data_, 0, MEM_RELEASE);
+#else
+            ::munmap(data_, bytes_);
+#endif
+        }
+    }
+
+    bool valid() const { return (data_ != nullptr); }
+    size_t size() const { return size_; }
+
+    T * begin() const { return data_; }
+    T * end() const { return data_ + size_; }
+};
+
+//
+// histogram_sort() of more than 4G uint32 keys, the uint64_t counts of histogram_sort(),
+// run by "SortBench --huge-sort [count_m]", count_m is the count of the keys in millions.
+// The keys are verified by the order and an order independent checksum.
+//
+void huge_sort_benchmark(size_t count_m)
+{
+    typedef uint32_t value_type;
+
+    static const uint32_t kKeyRanges[] = { 1024 * 1024, 0xFFFFFFFFu };
+
+    const double kGB = 1024.0 * 1024.0 * 1024.0;
+
+    size_t length = count_m * 1024 * 1024;
+    double total_gb = double(length) * sizeof(value_type) / kGB;
+
+    for (size_t n = 0; n < sizeof(kKeyRanges) / sizeof(kKeyRanges[0]); n++) {
+        uint32_t range = kKeyRanges[n];
+
+        printf(" huge_sort_benchmark, length = %" PRIu64 " (%0.2f GB), range = %u\n\n",
+               (uint64_t)length, total_gb, range);
+
+        HugePageArray<value_type> keys(length);
+        if (!keys.valid()) {
+            printf(" Can't allocate %0.2f GB.\n\n", total_gb);
+            return;
+        }
+
+        // xorshift64, rand32() is too slow for the billions of keys.
+        uint64_t state = 20230304ull;
+        uint64_t checksum = 0;
+        for (value_type * iter = keys.begin(); iter != keys.end(); ++iter) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            value_type key = static_cast<value_type>((state >> 16) % range);
+            *iter = key;
+            checksum += uint64_t(key) * 0x9E3779B97F4A7C15ull + (uint64_t(key) >> 3);
+        }
+
+        test::StopWatch sw;
+        sw.start();
+        jstd::histogram_sort(keys.begin(), keys.end());
+        sw.stop();
+
+        bool correctness = true;
+        uint64_t sorted_checksum = 0;
+        for (value_type * iter = keys.begin(); iter != keys.end(); ++iter) {
+            value_type key = *iter;
+            if (iter != keys.begin() && key < *(iter - 1))
+                correctness = false;
+            sorted_checksum += uint64_t(key) * 0x9E3779B97F4A7C15ull + (uint64_t(key) >> 3);
+        }
+        correctness = correctness && (sorted_checksum == checksum);
+
+        printf(" %-28s time: %10.3f ms, Per item time: %8.3f ns, verify = %s\n\n",
+               "jstd::histogram_sort", sw.getElapsedMillisec(),
+               sw.getElapsedNanosec() / double(length), correctness ? "Pass" : "Failed");
+    }
+}
+
 template <typename T, size_t MinLen, size_t MaxLen>
 bool histogram_sort_test_impl(T minVal, T maxVal)
 {
@@ -607,6 +1825,29 @@ int main(int argc, char * argv[])
 
     printf("Sort Algorithms Benchmark.\n\n");
 
+    printf("CPU features: %s\n", jstd::CPUFeatures::get().to_string().c_str());
+    printf("merge_2() kernel: %s\n\n", jstd::merge_kernel_name());
+
+    if (argc > 1 && strcmp(argv[1], "--external-sort") == 0) {
+        size_t size_mb   = (argc > 2) ? (size_t)atoi(argv[2]) : 1024;
+        size_t memory_mb = (argc > 3) ? (size_t)atoi(argv[3]) : 256;
+        external_sort_benchmark(size_mb, memory_mb);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--mmap-sort") == 0) {
+        size_t size_mb = (argc > 2) ? (size_t)atoi(argv[2]) : 1024;
+        mmap_sort_benchmark(size_mb);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--huge-sort") == 0) {
+        // 8.5G keys, 34 GB.
+        size_t count_m = (argc > 2) ? (size_t)atoi(argv[2]) : 8704;
+        huge_sort_benchmark(count_m);
+        return 0;
+    }
+
     //std::srand((unsigned int)std::time(0));
     std::srand((unsigned int)20230304L);
 
@@ -630,6 +1871,41 @@ int main(int argc, char * argv[])
 
         //sort_benchmark<uint32_t, ArrayKind::AllEqual>();
     }
+
+    if (1)
+    {
+        string_sort_benchmark();
+    }
+
+    if (1)
+    {
+        fat_record_benchmark();
+    }
+
+    if (1)
+    {
+        partial_sort_benchmark();
+    }
+
+    if (1)
+    {
+        merge_benchmark();
+    }
+
+    if (1)
+    {
+        sorted_insert_benchmark();
+    }
+
+    if (1)
+    {
+        descending_sort_benchmark();
+    }
+
+    if (1)
+    {
+        skewed_sort_benchmark();
+    }
 #endif
 
     printf("\n");
@@ -11,10 +11,23 @@
 #include "jstd/algorithms/BubbleSort.h"
 
 #include "jstd/algorithms/BinaryInsertSort.h"
+#include "jstd/algorithms/QuadSmallSort.h"
 #include "jstd/algorithms/HistogramSort.h"
+#include "jstd/algorithms/BatchSort.h"
+#include "jstd/algorithms/ParallelSort.h"
+#include "jstd/algorithms/SegmentedSort.h"
+#include "jstd/algorithms/StringSort.h"
+#include "jstd/algorithms/ArgSort.h"
+#include "jstd/algorithms/PartialSort.h"
+#include "jstd/algorithms/MergeK.h"
+#include "jstd/algorithms/SortedInsert.h"
+#include "jstd/algorithms/ExternalSort.h"
+#include "jstd/algorithms/MmapSort.h"
 
 #include "jstd/algorithms/SGIIntroSort.h"
 #include "jstd/algorithms/orlp-pdqsort.h"
 #include "jstd/algorithms/ska_sort.hpp"
+#include "jstd/algorithms/ska_sort_tuned.hpp"
+#include "jstd/algorithms/ska_sort_parallel.hpp"
 
 #endif // !JSTD_ALGORITHMS_H
@@ -0,0 +1,354 @@
+
+#ifndef JSTD_ARG_SORT_H
+#define JSTD_ARG_SORT_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+#include "jstd/algorithms/orlp-pdqsort.h"
+#include "jstd/algorithms/ska_sort.hpp"
+
+#include <assert.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+//
+// Index sort for heavyweight records.
+//
+// jstd::argsort(): the keys are extracted once into compact (key, index) pairs,
+// the pairs are sorted instead of the records, and the sorted indices are returned.
+// The engine is chosen by the key type:
+//
+//   integral keys of a dense range:  a stable counting sort of the indices (histogram),
+//   the other integral keys:         a LSD radix sort of the packed (key, index) words,
+//   the other arithmetic keys:       ska_sort() of the pairs (radix),
+//   the other keys:                  orlp::pdqsort() of the pairs by operator <.
+//
+// jstd::packed_argsort(): the integral keys of up to 32 bits and their indices are packed
+// into 64-bit words, (key << 32) | index, or (key << 48) | index for the keys of up to
+// 16 bits and the indices of up to 48 bits, and the words are sorted as primitive integers.
+// The words start in the order of their indices, so the stable LSD radix sort of
+// ska_detail::SizedRadixSorter<> only sorts the key part (3 passes of 11 bits for 32-bit
+// keys, 2 passes of 8 bits for 16-bit keys, the passes of a single bucket are skipped),
+// rather than all 8 bytes of the words, and the result is stable.
+//
+// jstd::sort_permute(): argsort(), then moves each record to its place once,
+// following the cycles of the permutation in place.
+//
+namespace jstd {
+namespace argsort_detail {
+
+// The max ratio of the key range to the length for the counting sort
+static const size_t kCountingRangeRatio = 2;
+
+// The max key range of the counting sort
+static const size_t kMaxCountingRange = 1 << 24;
+
+// The min length of the LSD radix sort of the packed words
+static const size_t kPackedRadixThreshold = 128;
+
+template <typename Key>
+struct KeyIndex {
+    Key      key;
+    uint32_t index;
+};
+
+struct GenericKeyTag {};
+struct ArithmeticKeyTag {};
+struct IntegralKeyTag {};
+
+template <typename Key>
+struct KeyCategory {
+    typedef typename std::conditional<
+                std::is_integral<Key>::value && !std::is_same<Key, bool>::value,
+                IntegralKeyTag,
+                typename std::conditional<std::is_arithmetic<Key>::value,
+                                          ArithmeticKeyTag, GenericKeyTag>::type
+            >::type type;
+};
+
+template <typename Key>
+void sort_pairs(std::vector<KeyIndex<Key>> & pairs, GenericKeyTag) {
+    orlp::pdqsort(pairs.begin(), pairs.end(),
+                  [](const KeyIndex<Key> & a, const KeyIndex<Key> & b) {
+                      return (a.key < b.key);
+                  });
+}
+
+template <typename Key>
+void sort_pairs(std::vector<KeyIndex<Key>> & pairs, ArithmeticKeyTag) {
+    ska_sort(pairs.begin(), pairs.end(),
+             [](const KeyIndex<Key> & pair) -> Key { return pair.key; });
+}
+
+template <typename Key>
+void sort_pairs(std::vector<KeyIndex<Key>> & pairs, IntegralKeyTag) {
+    sort_pairs(pairs, ArithmeticKeyTag());
+}
+
+template <typename Key>
+void pairs_to_indices(const std::vector<KeyIndex<Key>> & pairs, std::vector<uint32_t> & indices) {
+    size_t length = pairs.size();
+    for (size_t i = 0; i < length; i++) {
+        indices[i] = pairs[i].index;
+    }
+}
+
+template <typename Key>
+void argsort_pairs(std::vector<KeyIndex<Key>> & pairs, std::vector<uint32_t> & indices,
+                   GenericKeyTag) {
+    sort_pairs(pairs, GenericKeyTag());
+    pairs_to_indices(pairs, indices);
+}
+
+template <typename Key>
+void argsort_pairs(std::vector<KeyIndex<Key>> & pairs, std::vector<uint32_t> & indices,
+                   ArithmeticKeyTag) {
+    sort_pairs(pairs, ArithmeticKeyTag());
+    pairs_to_indices(pairs, indices);
+}
+
+//
+// The number of the high bits of a packed word used by the key.
+//
+template <typename Key>
+struct PackedKeyBits {
+    static const size_t value = (sizeof(Key) <= sizeof(uint16_t)) ? 16 : 32;
+};
+
+template <size_t KeyBits, typename Key>
+inline uint64_t pack_key_index(Key key, uint64_t index) {
+    typedef typename std::make_unsigned<Key>::type ukey_type;
+    static const size_t kKeyTypeBits = sizeof(Key) * 8;
+    static_assert((kKeyTypeBits <= KeyBits), "The key is wider than KeyBits.");
+
+    uint64_t ukey = static_cast<uint64_t>(static_cast<ukey_type>(key));
+    // Flip the sign bit, the signed keys are ordered as unsigned.
+    if (std::is_signed<Key>::value)
+        ukey ^= (uint64_t(1) << (kKeyTypeBits - 1));
+    return ((ukey << (64 - KeyBits)) | index);
+}
+
+//
+// Sort the packed words and unpack their indices, the words are clobbered.
+//
+template <size_t KeyBits, typename IndexType>
+void sort_packed_words(std::vector<uint64_t> & words, IndexType * indices) {
+    static const uint64_t kIndexMask = (uint64_t(1) << (64 - KeyBits)) - 1;
+
+    size_t length = words.size();
+    const uint64_t * sorted = words.data();
+    std::vector<uint64_t> buffer;
+    if (length < kPackedRadixThreshold) {
+        std::sort(words.begin(), words.end());
+    } else {
+        // The words are in the order of their indices, the LSD radix sort is stable,
+        // so only the key part needs to be sorted.
+        typedef typename std::conditional<(KeyBits <= 16), uint16_t, uint32_t>::type key_type;
+        buffer.resize(length);
+        bool in_buffer = ska_detail::SizedRadixSorter<sizeof(key_type)>::sort(
+                            words.data(), words.data() + length, buffer.data(),
+                            [](uint64_t word) -> key_type {
+                                return static_cast<key_type>(word >> (64 - KeyBits));
+                            });
+        if (in_buffer)
+            sorted = buffer.data();
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        indices[i] = static_cast<IndexType>(sorted[i] & kIndexMask);
+    }
+}
+
+template <typename Key>
+void sparse_argsort_pairs(std::vector<KeyIndex<Key>> & pairs, std::vector<uint32_t> & indices,
+                          std::false_type /* packable */) {
+    argsort_pairs(pairs, indices, ArithmeticKeyTag());
+}
+
+template <typename Key>
+void sparse_argsort_pairs(std::vector<KeyIndex<Key>> & pairs, std::vector<uint32_t> & indices,
+                          std::true_type /* packable */) {
+    static const size_t kKeyBits = PackedKeyBits<Key>::value;
+
+    size_t length = pairs.size();
+    std::vector<uint64_t> words(length);
+    for (size_t i = 0; i < length; i++) {
+        words[i] = pack_key_index<kKeyBits>(pairs[i].key, pairs[i].index);
+    }
+    sort_packed_words<kKeyBits>(words, indices.data());
+}
+
+//
+// A dense key range is sorted by counting, the indices are scattered directly
+// and the equal keys keep their order.
+//
+template <typename Key>
+void argsort_pairs(std::vector<KeyIndex<Key>> & pairs, std::vector<uint32_t> & indices,
+                   IntegralKeyTag) {
+    typedef typename std::make_unsigned<Key>::type ukey_type;
+
+    size_t length = pairs.size();
+    Key minKey = pairs[0].key;
+    Key maxKey = pairs[0].key;
+    for (size_t i = 1; i < length; i++) {
+        Key key = pairs[i].key;
+        minKey = (key < minKey) ? key : minKey;
+        maxKey = (key > maxKey) ? key : maxKey;
+    }
+
+    ukey_type distance = static_cast<ukey_type>(static_cast<ukey_type>(maxKey) -
+                                                static_cast<ukey_type>(minKey));
+    if (distance >= kMaxCountingRange || size_t(distance) > length * kCountingRangeRatio) {
+        sparse_argsort_pairs(pairs, indices,
+            std::integral_constant<bool, (sizeof(Key) <= sizeof(uint32_t))>());
+        return;
+    }
+
+    size_t range = size_t(distance) + 1;
+    std::vector<uint32_t> counts(range + 1, 0);
+    for (size_t i = 0; i < length; i++) {
+        size_t offset = size_t(static_cast<ukey_type>(static_cast<ukey_type>(pairs[i].key) -
+                                                      static_cast<ukey_type>(minKey)));
+        counts[offset + 1]++;
+    }
+    for (size_t i = 1; i < range; i++) {
+        counts[i] += counts[i - 1];
+    }
+    for (size_t i = 0; i < length; i++) {
+        size_t offset = size_t(static_cast<ukey_type>(static_cast<ukey_type>(pairs[i].key) -
+                                                      static_cast<ukey_type>(minKey)));
+        indices[counts[offset]++] = pairs[i].index;
+    }
+}
+
+//
+// Move first[indices[i]] to first[i] for all i, each record is moved once
+// (plus once into a temporary per cycle). The indices are reset to the identity.
+//
+template <typename RandomAccessIter>
+void permute_in_place(RandomAccessIter first, std::vector<uint32_t> & indices) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type value_type;
+
+    size_t length = indices.size();
+    for (size_t start = 0; start < length; start++) {
+        if (indices[start] == start)
+            continue;
+        value_type temp = std::move(first[start]);
+        size_t current = start;
+        while (true) {
+            size_t next = indices[current];
+            indices[current] = static_cast<uint32_t>(current);
+            if (next == start) {
+                first[current] = std::move(temp);
+                break;
+            }
+            first[current] = std::move(first[next]);
+            current = next;
+        }
+    }
+}
+
+} // namespace argsort_detail
+
+//
+// Return the indices of [first, last) in the order of key_fn(record),
+// key_fn(first[indices[0]]) <= key_fn(first[indices[1]]) <= ...
+// The length must be less than 2^32.
+//
+template <typename Iter, typename KeyFn>
+std::vector<uint32_t> argsort(Iter first, Iter last, KeyFn key_fn) {
+    typedef typename std::decay<decltype(key_fn(*first))>::type key_type;
+    typedef argsort_detail::KeyIndex<key_type> pair_type;
+    typedef typename argsort_detail::KeyCategory<key_type>::type key_category;
+
+    size_t length = static_cast<size_t>(std::distance(first, last));
+    assert(length <= size_t(std::numeric_limits<uint32_t>::max()));
+
+    std::vector<uint32_t> indices(length);
+    if (unlikely(length <= 1)) {
+        if (length == 1)
+            indices[0] = 0;
+        return indices;
+    }
+
+    std::vector<pair_type> pairs;
+    pairs.reserve(length);
+    uint32_t index = 0;
+    for (Iter iter = first; iter != last; ++iter) {
+        pairs.push_back(pair_type { key_fn(*iter), index });
+        index++;
+    }
+
+    argsort_detail::argsort_pairs(pairs, indices, key_category());
+    return indices;
+}
+
+template <typename Iter>
+std::vector<uint32_t> argsort(Iter first, Iter last) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    return argsort(first, last, [](const T & value) -> const T & { return value; });
+}
+
+//
+// Return the indices of [first, last) in the stable order of key_fn(record) in indices,
+// key_fn() returns an integral key of up to 32 bits (the length must be less than 2^32),
+// or up to 16 bits (the length must be less than 2^48).
+//
+template <typename Iter, typename KeyFn, typename IndexType>
+void packed_argsort(Iter first, Iter last, KeyFn key_fn, std::vector<IndexType> & indices) {
+    typedef typename std::decay<decltype(key_fn(*first))>::type key_type;
+    static const size_t kKeyBits = argsort_detail::PackedKeyBits<key_type>::value;
+    static_assert((std::is_integral<key_type>::value && (sizeof(key_type) <= sizeof(uint32_t))),
+                  "jstd::packed_argsort() only supports the integral keys of up to 32 bits.");
+    static_assert(std::is_integral<IndexType>::value,
+                  "jstd::packed_argsort() only supports the integral indices.");
+
+    size_t length = static_cast<size_t>(std::distance(first, last));
+    indices.resize(length);
+    if (unlikely(length == 0))
+        return;
+
+    assert((uint64_t(length) - 1) <= ((uint64_t(1) << (64 - kKeyBits)) - 1));
+    assert((uint64_t(length) - 1) <= uint64_t(std::numeric_limits<IndexType>::max()));
+
+    std::vector<uint64_t> words(length);
+    uint64_t index = 0;
+    for (Iter iter = first; iter != last; ++iter) {
+        words[index] = argsort_detail::pack_key_index<kKeyBits>(key_fn(*iter), index);
+        index++;
+    }
+    argsort_detail::sort_packed_words<kKeyBits>(words, indices.data());
+}
+
+template <typename Iter, typename IndexType>
+void packed_argsort(Iter first, Iter last, std::vector<IndexType> & indices) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    packed_argsort(first, last, [](const T & value) -> T { return value; }, indices);
+}
+
+//
+// Sort [first, last) by key_fn(record), moving every record once.
+//
+template <typename RandomAccessIter, typename KeyFn>
+void sort_permute(RandomAccessIter first, RandomAccessIter last, KeyFn key_fn) {
+    typedef typename std::iterator_traits<RandomAccessIter>::iterator_category iterator_category;
+    static_assert(std::is_same<iterator_category, std::random_access_iterator_tag>::value,
+                  "jstd::sort_permute() only supports random access iterators.");
+
+    std::vector<uint32_t> indices = jstd::argsort(first, last, key_fn);
+    argsort_detail::permute_in_place(first, indices);
+}
+
+} // namespace jstd
+
+#endif // !JSTD_ARG_SORT_H
@@ -0,0 +1,256 @@
+
+#ifndef JSTD_BATCH_SORT_H
+#define JSTD_BATCH_SORT_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+#include "jstd/algorithms/InsertSort.h"
+#include "jstd/algorithms/orlp-pdqsort.h"
+
+#include <assert.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <memory>       // For std::unique_ptr<T>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+//
+// Batched small-array sort over CSR-style (Compressed Sparse Row) segments.
+//
+//   offsets[0 .. count]:  segment i is data[offsets[i], offsets[i + 1]).
+//
+// Segments of length 2 .. kMaxNetworkLength are grouped by length, and each group is
+// sorted kBatchLanes segments at a time by a sorting network. The segments of a group
+// are transposed into a block where row r holds element r of every segment, so each
+// compare-exchange of the network is one branchless min/max over kBatchLanes lanes,
+// and one SIMD lane handles one segment (the lane loops are auto-vectorized).
+//
+// All the other segments go through a tight small-sort loop.
+//
+namespace jstd {
+namespace batch_detail {
+
+// The max segment length sorted by the sorting networks
+static const size_t kMaxNetworkLength = 8;
+
+// The number of segments sorted side by side in one transposed block
+static const size_t kBatchLanes = 16;
+
+// The threshold of built-in insertion sort
+static const size_t kInsertSortThreshold = 64;
+
+template <typename T, typename Comparer>
+JSTD_FORCED_INLINE
+void lanes_compare_swap(T * JSTD_RESTRICT row_a, T * JSTD_RESTRICT row_b, Comparer compare) {
+    for (size_t lane = 0; lane < kBatchLanes; lane++) {
+        T a = row_a[lane];
+        T b = row_b[lane];
+        bool swap = compare(b, a);
+        row_a[lane] = swap ? b : a;
+        row_b[lane] = swap ? a : b;
+    }
+}
+
+#define JSTD_LANES_CMP_SWAP(i, j) \
+    lanes_compare_swap(&block[(i) * kBatchLanes], &block[(j) * kBatchLanes], compare)
+
+//
+// Optimal (size) sorting networks for 2 .. 8 elements.
+//
+// See: https://bertdobbelaere.github.io/sorting_networks.html
+//
+template <typename T, typename Comparer>
+inline void lanes_sorting_network(T * block, size_t length, Comparer compare) {
+    switch (length) {
+    case 2:
+        JSTD_LANES_CMP_SWAP(0, 1);
+        break;
+    case 3:
+        JSTD_LANES_CMP_SWAP(0, 2); JSTD_LANES_CMP_SWAP(0, 1); JSTD_LANES_CMP_SWAP(1, 2);
+        break;
+    case 4:
+        JSTD_LANES_CMP_SWAP(0, 2); JSTD_LANES_CMP_SWAP(1, 3);
+        JSTD_LANES_CMP_SWAP(0, 1); JSTD_LANES_CMP_SWAP(2, 3);
+        JSTD_LANES_CMP_SWAP(1, 2);
+        break;
+    case 5:
+        JSTD_LANES_CMP_SWAP(0, 3); JSTD_LANES_CMP_SWAP(1, 4);
+        JSTD_LANES_CMP_SWAP(0, 2); JSTD_LANES_CMP_SWAP(1, 3);
+        JSTD_LANES_CMP_SWAP(0, 1); JSTD_LANES_CMP_SWAP(2, 4);
+        JSTD_LANES_CMP_SWAP(1, 2); JSTD_LANES_CMP_SWAP(3, 4);
+        JSTD_LANES_CMP_SWAP(2, 3);
+        break;
+    case 6:
+        JSTD_LANES_CMP_SWAP(0, 5); JSTD_LANES_CMP_SWAP(1, 3); JSTD_LANES_CMP_SWAP(2, 4);
+        JSTD_LANES_CMP_SWAP(1, 2); JSTD_LANES_CMP_SWAP(3, 4);
+        JSTD_LANES_CMP_SWAP(0, 3); JSTD_LANES_CMP_SWAP(2, 5);
+        JSTD_LANES_CMP_SWAP(0, 1); JSTD_LANES_CMP_SWAP(2, 3); JSTD_LANES_CMP_SWAP(4, 5);
+        JSTD_LANES_CMP_SWAP(1, 2); JSTD_LANES_CMP_SWAP(3, 4);
+        break;
+    case 7:
+        JSTD_LANES_CMP_SWAP(0, 6); JSTD_LANES_CMP_SWAP(2, 3); JSTD_LANES_CMP_SWAP(4, 5);
+        JSTD_LANES_CMP_SWAP(0, 2); JSTD_LANES_CMP_SWAP(1, 4); JSTD_LANES_CMP_SWAP(3, 6);
+        JSTD_LANES_CMP_SWAP(0, 1); JSTD_LANES_CMP_SWAP(2, 5); JSTD_LANES_CMP_SWAP(3, 4);
+        JSTD_LANES_CMP_SWAP(1, 2); JSTD_LANES_CMP_SWAP(4, 6);
+        JSTD_LANES_CMP_SWAP(2, 3); JSTD_LANES_CMP_SWAP(4, 5);
+        JSTD_LANES_CMP_SWAP(1, 2); JSTD_LANES_CMP_SWAP(3, 4); JSTD_LANES_CMP_SWAP(5, 6);
+        break;
+    case 8:
+        JSTD_LANES_CMP_SWAP(0, 2); JSTD_LANES_CMP_SWAP(1, 3); JSTD_LANES_CMP_SWAP(4, 6); JSTD_LANES_CMP_SWAP(5, 7);
+        JSTD_LANES_CMP_SWAP(0, 4); JSTD_LANES_CMP_SWAP(1, 5); JSTD_LANES_CMP_SWAP(2, 6); JSTD_LANES_CMP_SWAP(3, 7);
+        JSTD_LANES_CMP_SWAP(0, 1); JSTD_LANES_CMP_SWAP(2, 3); JSTD_LANES_CMP_SWAP(4, 5); JSTD_LANES_CMP_SWAP(6, 7);
+        JSTD_LANES_CMP_SWAP(2, 4); JSTD_LANES_CMP_SWAP(3, 5);
+        JSTD_LANES_CMP_SWAP(1, 4); JSTD_LANES_CMP_SWAP(3, 6);
+        JSTD_LANES_CMP_SWAP(1, 2); JSTD_LANES_CMP_SWAP(3, 4); JSTD_LANES_CMP_SWAP(5, 6);
+        break;
+    default:
+        assert(false);
+        break;
+    }
+}
+
+#undef JSTD_LANES_CMP_SWAP
+
+//
+// Sort the segments listed in seg_index[0 .. seg_count), all of them have the same length.
+//
+template <typename OffsetType, typename T, typename Comparer>
+inline void network_sort_group(const OffsetType * offsets, T * data,
+                               const size_t * seg_index, size_t seg_count,
+                               size_t length, Comparer compare) {
+    T block[kMaxNetworkLength * kBatchLanes];
+
+    assert(length >= 2 && length <= kMaxNetworkLength);
+    for (size_t base = 0; base < seg_count; base += kBatchLanes) {
+        size_t lanes = ((seg_count - base) < kBatchLanes) ? (seg_count - base) : kBatchLanes;
+
+        // Transpose: lane l <= segment seg_index[base + l]
+        for (size_t lane = 0; lane < lanes; lane++) {
+            const T * segment = data + offsets[seg_index[base + lane]];
+            for (size_t row = 0; row < length; row++) {
+                block[row * kBatchLanes + lane] = segment[row];
+            }
+        }
+        // Pad the unused lanes with a copy of lane 0, their results are discarded.
+        for (size_t lane = lanes; lane < kBatchLanes; lane++) {
+            for (size_t row = 0; row < length; row++) {
+                block[row * kBatchLanes + lane] = block[row * kBatchLanes];
+            }
+        }
+
+        lanes_sorting_network(block, length, compare);
+
+        // Transpose back
+        for (size_t lane = 0; lane < lanes; lane++) {
+            T * segment = data + offsets[seg_index[base + lane]];
+            for (size_t row = 0; row < length; row++) {
+                segment[row] = block[row * kBatchLanes + lane];
+            }
+        }
+    }
+}
+
+template <typename T, typename Comparer>
+inline void small_sort(T * first, T * last, Comparer compare) {
+    size_t length = static_cast<size_t>(last - first);
+    if (likely(length <= kInsertSortThreshold))
+        jstd::insert_sort(first, last, compare);
+    else
+        orlp::pdqsort(first, last, compare);
+}
+
+template <typename OffsetType, typename T, typename Comparer>
+inline void sort_batch_loop(const OffsetType * offsets, T * data, size_t count, Comparer compare) {
+    for (size_t i = 0; i < count; i++) {
+        T * first = data + offsets[i];
+        T * last  = data + offsets[i + 1];
+        if (likely((last - first) > 1)) {
+            small_sort(first, last, compare);
+        }
+    }
+}
+
+template <typename OffsetType, typename T, typename Comparer>
+inline void sort_batch(const OffsetType * offsets, T * data, size_t count,
+                       Comparer compare, std::true_type /* use sorting networks */) {
+    size_t group_counts[kMaxNetworkLength + 1] = { 0 };
+    size_t network_total = 0;
+
+    // Pass 1: histogram of the segment lengths, and sort the long segments directly.
+    for (size_t i = 0; i < count; i++) {
+        size_t length = static_cast<size_t>(offsets[i + 1] - offsets[i]);
+        if (likely(length <= kMaxNetworkLength)) {
+            group_counts[length]++;
+        } else {
+            small_sort(data + offsets[i], data + offsets[i + 1], compare);
+        }
+    }
+    for (size_t length = 2; length <= kMaxNetworkLength; length++) {
+        network_total += group_counts[length];
+    }
+    if (network_total == 0)
+        return;
+
+    // Pass 2: group the short segments by length (a counting sort of the segment indexes).
+    size_t group_start[kMaxNetworkLength + 1];
+    size_t group_fill[kMaxNetworkLength + 1];
+    size_t total = 0;
+    for (size_t length = 0; length <= kMaxNetworkLength; length++) {
+        group_start[length] = total;
+        group_fill[length] = total;
+        if (length >= 2)
+            total += group_counts[length];
+    }
+
+    std::unique_ptr<size_t[]> seg_index(new size_t[network_total]);
+    for (size_t i = 0; i < count; i++) {
+        size_t length = static_cast<size_t>(offsets[i + 1] - offsets[i]);
+        if (length >= 2 && length <= kMaxNetworkLength) {
+            seg_index[group_fill[length]++] = i;
+        }
+    }
+
+    // Pass 3: sort each same-length group with the transposed sorting network.
+    for (size_t length = 2; length <= kMaxNetworkLength; length++) {
+        if (group_counts[length] != 0) {
+            network_sort_group(offsets, data, &seg_index[group_start[length]],
+                               group_counts[length], length, compare);
+        }
+    }
+}
+
+template <typename OffsetType, typename T, typename Comparer>
+inline void sort_batch(const OffsetType * offsets, T * data, size_t count,
+                       Comparer compare, std::false_type /* use sorting networks */) {
+    sort_batch_loop(offsets, data, count, compare);
+}
+
+} // namespace batch_detail
+
+//
+// Sort the count segments data[offsets[i], offsets[i + 1]) independently.
+//
+template <typename OffsetType, typename T, typename Comparer>
+void sort_batch(const OffsetType * offsets, T * data, size_t count, Comparer compare) {
+    typedef std::integral_constant<bool,
+            std::is_arithmetic<T>::value || std::is_pointer<T>::value> use_networks;
+    static_assert(std::is_integral<OffsetType>::value,
+                  "jstd::sort_batch(): OffsetType must be a integral type.");
+    if (likely(count != 0))
+        batch_detail::sort_batch(offsets, data, count, compare, use_networks());
+}
+
+template <typename OffsetType, typename T>
+void sort_batch(const OffsetType * offsets, T * data, size_t count) {
+    sort_batch(offsets, data, count, std::less<T>());
+}
+
+} // namespace jstd
+
+#endif // !JSTD_BATCH_SORT_H
@@ -7,10 +7,12 @@
 #endif
 
 #include "jstd/basic/stddef.h"
+#include "jstd/support/IteratorTraits.h"
 
 #include <assert.h>
 
 #include <cstddef>
+#include <cstring>      // For std::memmove()
 #include <iterator>
 #include <type_traits>
 #include <utility>
@@ -19,6 +21,12 @@
 namespace jstd {
 namespace insert_detail {
 
+// The min length of the memmove() path of binary_insert_sort_v2()
+static const ptrdiff_t kMemmoveInsertThreshold = 128;
+
+// The width of the window of the lane count, the search stops at it
+static const ptrdiff_t kLaneCountWindow = 16;
+
 //
 // std::random_access_iterator_tag
 //
@@ -138,8 +146,8 @@ inline void binary_insert_sort_v1(ForwardIter first, ForwardIter last,
 }
 
 template <typename RandomAccessIter, typename Comparer>
-inline void binary_insert_sort_v2(RandomAccessIter first, RandomAccessIter last,
-                                  Comparer compare, std::random_access_iterator_tag) {
+inline void binary_insert_sort_v2_impl(RandomAccessIter first, RandomAccessIter last,
+                                       Comparer compare, std::false_type) {
     typedef RandomAccessIter iterator;
     typedef typename std::iterator_traits<iterator>::value_type      T;
     typedef typename std::iterator_traits<iterator>::difference_type diff_type;
@@ -238,6 +246,58 @@ NextLoop:
     }
 }
 
+//
+// The trivially copyable values on the contiguous storage: the position is found by
+// a branchless binary search down to a window of kLaneCountWindow elements, then
+// by counting the elements of the window not greater than the key (upper bound,
+// the sort is stable), the counting loop has no branch and is vectorized to the
+// SIMD compares. The elements after the position are shifted by one memmove().
+//
+template <typename RandomAccessIter, typename Comparer>
+inline void binary_insert_sort_v2_impl(RandomAccessIter first, RandomAccessIter last,
+                                       Comparer compare, std::true_type) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type T;
+
+    ptrdiff_t length = last - first;
+    if (length < kMemmoveInsertThreshold) {
+        binary_insert_sort_v2_impl(first, last, compare, std::false_type());
+        return;
+    }
+
+    T * const data = &*first;
+    for (ptrdiff_t i = 1; i < length; i++) {
+        T key = data[i];
+        if (!compare(key, data[i - 1]))
+            continue;
+
+        // The upper bound of key in [data, data + i - 1).
+        const T * base = data;
+        ptrdiff_t count = i - 1;
+        while (count > kLaneCountWindow) {
+            ptrdiff_t half = count / 2;
+            base = !compare(key, base[half]) ? (base + half) : base;
+            count -= half;
+        }
+        ptrdiff_t lanes = 0;
+        for (ptrdiff_t n = 0; n < count; n++) {
+            lanes += static_cast<ptrdiff_t>(!compare(key, base[n]));
+        }
+
+        T * pos = data + (base - data) + lanes;
+        std::memmove((void *)(pos + 1), (const void *)pos, (data + i - pos) * sizeof(T));
+        *pos = key;
+    }
+}
+
+template <typename RandomAccessIter, typename Comparer>
+inline void binary_insert_sort_v2(RandomAccessIter first, RandomAccessIter last,
+                                  Comparer compare, std::random_access_iterator_tag) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type T;
+    typedef std::integral_constant<bool, std::is_trivially_copyable<T>::value &&
+                                         is_contiguous_iterator<RandomAccessIter, T>::value> use_memmove;
+    binary_insert_sort_v2_impl(first, last, compare, use_memmove());
+}
+
 template <typename BiDirectionalIter, typename Comparer>
 inline void binary_insert_sort_v2(BiDirectionalIter first, BiDirectionalIter last,
                                   Comparer compare, std::bidirectional_iterator_tag) {
@@ -0,0 +1,534 @@
+
+#ifndef JSTD_EXTERNAL_SORT_H
+#define JSTD_EXTERNAL_SORT_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#ifdef _MSC_VER
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#endif
+
+#include "jstd/basic/stddef.h"
+#include "jstd/support/LoserTree.h"
+#include "jstd/support/TaskPool.h"
+#include "jstd/algorithms/ska_sort.hpp"
+
+#include <assert.h>
+#include <stdio.h>      // For fopen(), fread(), fwrite(), remove()
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>       // For std::unique_ptr<T>
+#include <chrono>
+#include <functional>   // For std::less<T>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+//
+// External merge sort of a binary file of fixed size records (the file is an array of T).
+//
+// Phase 1, run generation: the input is read in chunks of about memory_bytes / 3
+// by large sequential reads, each chunk is sorted by ska_sort_copy() and written to
+// a temporary run file. The write of a run is behind the read and sort of the next chunk,
+// the three buffers are the chunk being read, the radix sort buffer and the run being written.
+//
+// Phase 2, merge: the runs are merged by a k-way loser tree (jstd::LoserTree).
+// Every run is read ahead by a double buffered asynchronous reader, and the output is
+// written behind by a double buffered asynchronous writer. More runs than max_fan_in
+// are merged by several passes.
+//
+// The background reads and writes are the tasks of a jstd::TaskPool of io_threads,
+// so a merge of many runs doesn't start a thread per block.
+//
+namespace jstd {
+
+struct ExternalSortOptions {
+    // The memory of the run generation and of the merge buffers
+    size_t      memory_bytes;
+    // The max size of a read-ahead or write-behind block
+    size_t      io_block_bytes;
+    // The max number of runs merged by one pass
+    size_t      max_fan_in;
+    // The threads of the background reads and writes, including the sorting thread,
+    // 1 is the synchronous I/O
+    size_t      io_threads;
+    // The directory of the temporary run files, next to the output file if empty
+    std::string temp_dir;
+
+    ExternalSortOptions()
+        : memory_bytes(size_t(256) * 1024 * 1024),
+          io_block_bytes(size_t(4) * 1024 * 1024),
+          max_fan_in(256),
+          io_threads(4) {
+    }
+};
+
+struct ExternalSortStats {
+    uint64_t bytes;
+    size_t   runs;
+    size_t   merge_passes;
+    double   run_seconds;
+    double   merge_seconds;
+
+    ExternalSortStats()
+        : bytes(0), runs(0), merge_passes(0), run_seconds(0.0), merge_seconds(0.0) {
+    }
+};
+
+namespace external_detail {
+
+// The smallest read-ahead or write-behind block
+static const size_t kMinBlockBytes = 64 * 1024;
+
+class BinaryFile {
+private:
+    FILE * file_;
+
+public:
+    BinaryFile() noexcept : file_(nullptr) {}
+    ~BinaryFile() {
+        this->close();
+    }
+
+    bool is_open() const { return (file_ != nullptr); }
+
+    bool open(const std::string & path, const char * mode) {
+        this->close();
+        file_ = fopen(path.c_str(), mode);
+        if (file_ == nullptr)
+            return false;
+        // The reads and writes are large blocks, don't copy them through the stdio buffer.
+        setvbuf(file_, nullptr, _IONBF, 0);
+        return true;
+    }
+
+    bool close() {
+        bool success = true;
+        if (file_ != nullptr) {
+            FILE * file = file_;
+            file_ = nullptr;
+            success = (fclose(file) == 0);
+        }
+        return success;
+    }
+
+    size_t read(void * data, size_t bytes) {
+        assert(file_ != nullptr);
+        return fread(data, 1, bytes, file_);
+    }
+
+    bool write(const void * data, size_t bytes) {
+        assert(file_ != nullptr);
+        return (fwrite(data, 1, bytes, file_) == bytes);
+    }
+
+private:
+    BinaryFile(const BinaryFile &) = delete;
+    BinaryFile & operator = (const BinaryFile &) = delete;
+};
+
+//
+// Read the records of a file block by block, the next block is read in the background
+// while the current block is consumed.
+//
+template <typename T>
+class AsyncBlockReader {
+private:
+    BinaryFile           file_;
+    std::unique_ptr<T[]> buffers_[2];
+    size_t               block_records_;
+    size_t               next_;
+    bool                 error_;
+    bool                 pending_;
+    size_t               read_bytes_;
+    TaskPool *           pool_;
+    TaskGroup            group_;
+
+public:
+    AsyncBlockReader() noexcept
+        : block_records_(0), next_(0), error_(false), pending_(false),
+          read_bytes_(0), pool_(nullptr) {}
+    ~AsyncBlockReader() {
+        if (pending_)
+            pool_->wait(group_);
+    }
+
+    bool has_error() const { return error_; }
+
+    bool open(const std::string & path, size_t block_records, TaskPool & pool) {
+        assert(block_records > 0);
+        if (!file_.open(path, "rb"))
+            return false;
+        pool_ = &pool;
+        block_records_ = block_records;
+        buffers_[0].reset(new T[block_records]);
+        buffers_[1].reset(new T[block_records]);
+        next_ = 0;
+        error_ = false;
+        start_read(next_);
+        return true;
+    }
+
+    //
+    // The block is valid until the next call.
+    //
+    bool next_block(const T *& data, size_t & count) {
+        if (!pending_)
+            return false;
+        pool_->wait(group_);
+        pending_ = false;
+        size_t bytes = read_bytes_;
+        if (bytes % sizeof(T) != 0)
+            error_ = true;
+        count = bytes / sizeof(T);
+        if (count == 0)
+            return false;
+        data = buffers_[next_].get();
+        next_ ^= 1;
+        if (count == block_records_)
+            start_read(next_);
+        return true;
+    }
+
+private:
+    void start_read(size_t index) {
+        T * buffer = buffers_[index].get();
+        size_t bytes = block_records_ * sizeof(T);
+        pending_ = true;
+        pool_->submit(group_, [this, buffer, bytes]() {
+            this->read_bytes_ = this->file_.read(buffer, bytes);
+        });
+    }
+};
+
+//
+// Write the records to a file block by block, a full block is written in the background
+// while the next block is filled.
+//
+template <typename T>
+class AsyncBlockWriter {
+private:
+    BinaryFile           file_;
+    std::unique_ptr<T[]> buffers_[2];
+    size_t               block_records_;
+    size_t               current_;
+    size_t               count_;
+    bool                 error_;
+    bool                 pending_;
+    bool                 written_;
+    TaskPool *           pool_;
+    TaskGroup            group_;
+
+public:
+    AsyncBlockWriter() noexcept
+        : block_records_(0), current_(0), count_(0), error_(false),
+          pending_(false), written_(true), pool_(nullptr) {}
+    ~AsyncBlockWriter() {
+        this->wait();
+    }
+
+    bool open(const std::string & path, size_t block_records, TaskPool & pool) {
+        assert(block_records > 0);
+        if (!file_.open(path, "wb"))
+            return false;
+        pool_ = &pool;
+        block_records_ = block_records;
+        buffers_[0].reset(new T[block_records]);
+        buffers_[1].reset(new T[block_records]);
+        current_ = 0;
+        count_ = 0;
+        error_ = false;
+        return true;
+    }
+
+    void push_back(const T & value) {
+        buffers_[current_][count_++] = value;
+        if (unlikely(count_ == block_records_))
+            flush_block();
+    }
+
+    // Flush and close the file, return false if any write is failed.
+    bool close() {
+        if (count_ != 0)
+            flush_block();
+        this->wait();
+        if (!file_.close())
+            error_ = true;
+        return !error_;
+    }
+
+private:
+    void wait() {
+        if (pending_) {
+            pool_->wait(group_);
+            pending_ = false;
+            if (!written_)
+                error_ = true;
+        }
+    }
+
+    void flush_block() {
+        this->wait();
+        const T * buffer = buffers_[current_].get();
+        size_t bytes = count_ * sizeof(T);
+        pending_ = true;
+        pool_->submit(group_, [this, buffer, bytes]() {
+            this->written_ = this->file_.write(buffer, bytes);
+        });
+        current_ ^= 1;
+        count_ = 0;
+    }
+};
+
+inline double elapsed_seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline std::string run_file_prefix(const std::string & output_path, const std::string & temp_dir) {
+    if (temp_dir.empty())
+        return output_path;
+    size_t pos = output_path.find_last_of("/\\");
+    std::string name = (pos != std::string::npos) ? output_path.substr(pos + 1) : output_path;
+    return (temp_dir + "/" + name);
+}
+
+inline std::string run_file_path(const std::string & prefix, size_t pass, size_t index) {
+    return (prefix + ".run" + std::to_string(pass) + "." + std::to_string(index));
+}
+
+inline void remove_files(const std::vector<std::string> & paths) {
+    for (const std::string & path : paths) {
+        remove(path.c_str());
+    }
+}
+
+//
+// Sort the chunk, return the buffer of the result, chunk or buffer.
+//
+template <typename T>
+T * sort_run(T * chunk, T * buffer, size_t count) {
+    bool in_buffer = ska_sort_copy(chunk, chunk + count, buffer);
+    return (in_buffer ? buffer : chunk);
+}
+
+template <typename T>
+bool write_run(const std::string & path, const T * data, size_t count) {
+    BinaryFile file;
+    if (!file.open(path, "wb"))
+        return false;
+    bool success = file.write(data, count * sizeof(T));
+    return (file.close() && success);
+}
+
+//
+// Phase 1: sort the chunks of the input into the run files.
+//
+template <typename T>
+bool generate_runs(const std::string & input_path, const std::string & prefix,
+                   const ExternalSortOptions & options, TaskPool & io_pool,
+                   std::vector<std::string> & runs, uint64_t & total_bytes) {
+    size_t chunk_records = options.memory_bytes / (3 * sizeof(T));
+    chunk_records = (chunk_records > 0) ? chunk_records : 1;
+
+    BinaryFile input;
+    if (!input.open(input_path, "rb"))
+        return false;
+
+    std::unique_ptr<T[]> buffers[3];
+    for (size_t i = 0; i < 3; i++) {
+        buffers[i].reset(new T[chunk_records]);
+    }
+
+    bool success = true;
+    size_t writing = 3;     // The buffer of the pending write, none
+    bool written = true;
+    TaskGroup pending;
+    total_bytes = 0;
+
+    while (success) {
+        // The chunk and the sort buffer are the two buffers not being written.
+        size_t chunk = (writing != 0) ? 0 : 1;
+        size_t scratch = (writing != 2 && chunk != 2) ? 2 : 1;
+        size_t bytes = input.read(buffers[chunk].get(), chunk_records * sizeof(T));
+        if (bytes % sizeof(T) != 0) {
+            success = false;
+            break;
+        }
+        if (bytes == 0)
+            break;
+        total_bytes += bytes;
+
+        size_t count = bytes / sizeof(T);
+        T * sorted = sort_run(buffers[chunk].get(), buffers[scratch].get(), count);
+        size_t result = (sorted == buffers[chunk].get()) ? chunk : scratch;
+
+        io_pool.wait(pending);
+        if (!written) {
+            success = false;
+            break;
+        }
+        std::string path = run_file_path(prefix, 0, runs.size());
+        runs.push_back(path);
+        io_pool.submit(pending, [path, sorted, count, &written]() {
+            written = write_run(path, sorted, count);
+        });
+        writing = result;
+
+        if (count < chunk_records)
+            break;
+    }
+
+    io_pool.wait(pending);
+    if (!written)
+        success = false;
+    return success;
+}
+
+template <typename T>
+bool merge_runs(const std::vector<std::string> & runs, const std::string & output_path,
+                size_t block_records, TaskPool & io_pool) {
+    size_t sources = runs.size();
+    std::vector<AsyncBlockReader<T>> readers(sources);
+    std::vector<const T *> cursors(sources, nullptr);
+    std::vector<const T *> limits(sources, nullptr);
+    LoserTree<T> tree(sources);
+
+    for (size_t i = 0; i < sources; i++) {
+        if (!readers[i].open(runs[i], block_records, io_pool))
+            return false;
+    }
+    for (size_t i = 0; i < sources; i++) {
+        const T * data;
+        size_t count;
+        if (readers[i].next_block(data, count)) {
+            cursors[i] = data + 1;
+            limits[i] = data + count;
+            tree.set_head(i, data[0]);
+        }
+    }
+    tree.build();
+
+    AsyncBlockWriter<T> writer;
+    if (!writer.open(output_path, block_records, io_pool))
+        return false;
+
+    while (!tree.empty()) {
+        size_t source = tree.top();
+        writer.push_back(tree.top_value());
+        if (likely(cursors[source] != limits[source])) {
+            tree.replace_top(*cursors[source]++);
+        } else {
+            const T * data;
+            size_t count;
+            if (readers[source].next_block(data, count)) {
+                cursors[source] = data + 1;
+                limits[source] = data + count;
+                tree.replace_top(data[0]);
+            } else {
+                tree.pop_top();
+            }
+        }
+    }
+
+    bool success = writer.close();
+    for (size_t i = 0; i < sources; i++) {
+        if (readers[i].has_error())
+            success = false;
+    }
+    return success;
+}
+
+//
+// Each run has two read blocks, the output has two write blocks.
+//
+template <typename T>
+size_t merge_block_records(const ExternalSortOptions & options, size_t sources) {
+    size_t block_bytes = options.memory_bytes / (2 * (sources + 1));
+    block_bytes = (block_bytes < options.io_block_bytes) ? block_bytes : options.io_block_bytes;
+    block_bytes = (block_bytes > kMinBlockBytes) ? block_bytes : kMinBlockBytes;
+    size_t block_records = block_bytes / sizeof(T);
+    return ((block_records > 0) ? block_records : 1);
+}
+
+} // namespace external_detail
+
+//
+// Sort the binary file of T records input_path into output_path.
+// T is an arithmetic type (the key is the record), the file size must be a multiple
+// of sizeof(T). Return false on an I/O error.
+//
+template <typename T>
+bool external_sort(const std::string & input_path, const std::string & output_path,
+                   const ExternalSortOptions & options = ExternalSortOptions(),
+                   ExternalSortStats * stats = nullptr) {
+    static_assert(std::is_arithmetic<T>::value,
+                  "jstd::external_sort() only supports the arithmetic types.");
+    using namespace external_detail;
+
+    std::string prefix = run_file_prefix(output_path, options.temp_dir);
+    size_t max_fan_in = (options.max_fan_in >= 2) ? options.max_fan_in : 2;
+    TaskPool io_pool((options.io_threads >= 1) ? options.io_threads : 1);
+
+    ExternalSortStats local_stats;
+    ExternalSortStats & stat = (stats != nullptr) ? *stats : local_stats;
+    stat = ExternalSortStats();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::string> runs;
+    bool success = generate_runs<T>(input_path, prefix, options, io_pool, runs, stat.bytes);
+    stat.runs = runs.size();
+    stat.run_seconds = elapsed_seconds(start);
+    if (!success) {
+        remove_files(runs);
+        return false;
+    }
+
+    start = std::chrono::steady_clock::now();
+    size_t pass = 0;
+    while (success && runs.size() > max_fan_in) {
+        pass++;
+        std::vector<std::string> merged;
+        for (size_t first = 0; first < runs.size(); first += max_fan_in) {
+            size_t last = (std::min)(first + max_fan_in, runs.size());
+            std::vector<std::string> group(runs.begin() + first, runs.begin() + last);
+            std::string path = run_file_path(prefix, pass, merged.size());
+            merged.push_back(path);
+            success = merge_runs<T>(group, path, merge_block_records<T>(options, group.size()),
+                                    io_pool);
+            remove_files(group);
+            if (!success)
+                break;
+        }
+        if (!success) {
+            remove_files(runs);
+            remove_files(merged);
+            return false;
+        }
+        runs.swap(merged);
+    }
+
+    if (!runs.empty()) {
+        success = merge_runs<T>(runs, output_path, merge_block_records<T>(options, runs.size()),
+                                io_pool);
+    } else {
+        // The input is empty.
+        BinaryFile output;
+        success = output.open(output_path, "wb") && output.close();
+    }
+    remove_files(runs);
+    // The empty input has no merge.
+    stat.merge_passes = runs.empty() ? pass : (pass + 1);
+    stat.merge_seconds = elapsed_seconds(start);
+    return success;
+}
+
+} // namespace jstd
+
+#endif // !JSTD_EXTERNAL_SORT_H
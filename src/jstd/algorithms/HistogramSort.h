@@ -7,18 +7,23 @@
 #endif
 
 #include "jstd/basic/stddef.h"
+#include "jstd/algorithms/InsertSort.h"
 #include "jstd/support/BitUtils.h"
+#include "jstd/support/CacheInfo.h"
 #include "jstd/support/Power2.h"
 
 #include <assert.h>
 
 #include <cstdint>
 #include <cstddef>
+#include <cstdlib>      // For std::calloc(), std::free()
 #include <iterator>
 #include <limits>       // For std::min(), std::max()
 #include <memory>       // For std::unique_ptr<T>
 #include <cstring>      // For std::memset()
+#include <vector>
 #include <bitset>       // For std::bitset<N>
+#include <functional>   // For std::less<T>, std::greater<T>
 #include <type_traits>
 #include <utility>
 #include <algorithm>
@@ -32,6 +37,53 @@ static const size_t kInsertSortThreshold = 128;
 // The threshold of std::sort()
 static const size_t kStdSortThreshold = 128;
 
+// The max distance per value of the sparse counting sort
+static const size_t kSparseMaxDistanceRatio = sizeof(size_t) * 8;
+
+// The max distance per value of the dense counting sort of the wide ranges
+static const size_t kWideDenseMaxDistanceRatio = 2;
+
+// The min and max distance per value of the hierarchical counting sort
+static const size_t kHierarchicalMinDistanceRatio = 16;
+static const size_t kHierarchicalMaxDistanceRatio = 64;
+
+// The max duplicate values of the hierarchical counting sort, 1 / 16 of the scanned values
+static const size_t kHierarchicalMaxDupRatio = 16;
+
+// The scanned values before the duplicate check of the hierarchical counting sort
+static const size_t kHierarchicalMinDupScan = 4096;
+
+// The max count of a bucket placed by insertion in proxmap_sort(), else the MSD recursion
+static const size_t kProxmapMaxInsertCount = 32;
+
+// The max count of a bucket sorted by insertion sort in the MSD recursion
+static const size_t kMsdInsertSortThreshold = 32;
+
+// The bounds of the bucket count of a level
+static const size_t kMinBucketCount = 256;
+static const size_t kMaxBucketCount = 1024 * 1024;
+
+// The min length of the sample sort mode
+static const size_t kSampleSortMinLength = 16384;
+
+// The sample of the skew check: the proxmap buckets of the sampled values
+static const size_t kSkewSampleSize = 256;
+
+// The sample is skewed if a proxmap bucket has this many sampled values (1 / 16)
+static const size_t kSkewSampleMaxCount = 16;
+
+// The depth of the splitter tree of the sample sort, 256 buckets
+static const size_t kSplitterTreeDepth = 8;
+
+// The sampled values per bucket of the sample sort
+static const size_t kSampleOversampling = 8;
+
+// The max length of the sample sort which keeps the bucket ids of all the values (32 MB)
+static const size_t kSampleSortMaxBucketIds = 16 * 1024 * 1024;
+
+// The values classified per block of the sample sort, beyond kSampleSortMaxBucketIds
+static const size_t kSampleSortBlockSize = 1024;
+
 template <typename T, typename CountType>
 struct SortBucket {
     typedef T                                            value_type;
@@ -90,9 +142,90 @@ inline size_t ilog2(T n)
     return exponent;
 }
 
-template <typename CountType, typename Iterator, typename Comparer,
+//
+// The distance of two keys (minKey <= maxKey) in the unsigned type of the keys,
+// the signed keys don't overflow.
+//
+template <typename KeyType>
+inline uint64_t key_distance(const KeyType & minKey, const KeyType & maxKey) {
+    typedef typename std::make_unsigned<KeyType>::type unsigned_key;
+    return static_cast<uint64_t>(static_cast<unsigned_key>(
+        static_cast<unsigned_key>(maxKey) - static_cast<unsigned_key>(minKey)));
+}
+
+//
+// The orders of histogram_sort(): the values are sorted by the keys of KeyMap,
+// ascending or descending, a key map must keep the order of the values.
+//
+// IdentityKey: the key is the value, the counting sorts rebuild the values from
+// the counts of the keys. The values of the other key maps are moved by the proxmap sort.
+//
+struct IdentityKey {
+    template <typename T>
+    const T & operator () (const T & value) const {
+        return value;
+    }
+};
+
+template <typename T, typename KeyMap, bool Descending>
+struct KeyOrder {
+    typedef typename std::decay<decltype(std::declval<const KeyMap &>()(std::declval<const T &>()))>::type
+            key_type;
+
+    static const bool kDescending = Descending;
+    static const bool kIdentity = std::is_same<KeyMap, IdentityKey>::value;
+
+    KeyMap key_map;
+
+    explicit KeyOrder(const KeyMap & key_map = KeyMap()) : key_map(key_map) {}
+
+    key_type key(const T & value) const {
+        return key_map(value);
+    }
+
+    // The distance of the key from the first key of the order.
+    size_t offset(const T & value, const key_type & minKey, const key_type & maxKey) const {
+        return Descending ? static_cast<size_t>(key_distance(key(value), maxKey))
+                          : static_cast<size_t>(key_distance(minKey, key(value)));
+    }
+
+    // It's the comparer of the small sorts and the proxmap sort.
+    bool operator () (const T & a, const T & b) const {
+        return Descending ? (key(b) < key(a)) : (key(a) < key(b));
+    }
+};
+
+//
+// The order of Comparer, the unknown comparers (void) are sorted by a comparison sort.
+//
+template <typename T, typename Comparer>
+struct comparer_order {
+    typedef void type;
+};
+
+template <typename T>
+struct comparer_order<T, std::less<T>> {
+    typedef KeyOrder<T, IdentityKey, false> type;
+};
+
+template <typename T>
+struct comparer_order<T, std::greater<T>> {
+    typedef KeyOrder<T, IdentityKey, true> type;
+};
+
+template <typename T>
+struct comparer_order<T, std::less<void>> {
+    typedef KeyOrder<T, IdentityKey, false> type;
+};
+
+template <typename T>
+struct comparer_order<T, std::greater<void>> {
+    typedef KeyOrder<T, IdentityKey, true> type;
+};
+
+template <typename CountType, bool Descending, typename Iterator,
           typename DiffType, typename ValueType>
-inline void dense_counting_sort(Iterator first, Iterator last, Comparer compare,
+inline void dense_counting_sort(Iterator first, Iterator last,
                                 DiffType distance, const ValueType & minVal) {
     typedef Iterator iterator;
     typedef typename std::make_unsigned<CountType>::type             count_type;
@@ -105,18 +238,19 @@ inline void dense_counting_sort(Iterator first, Iterator last, Comparer compare,
     assert(length > 0);
 
     assert(distance > 0);
-    if (likely(distance < diff_type(kFixedDistance))) {
+    if (likely(distance < diff_type(kFixedDistance) && sizeof(count_type) <= sizeof(uint32_t))) {
         count_type counts[kFixedDistance];
         std::memset(&counts[0], 0, sizeof(count_type) * (distance + 1));
 
         iterator iter;
         for (iter = first; iter < last; ++iter) {
-            value_type idx = *iter - minVal;
+            size_t idx = static_cast<size_t>(key_distance(minVal, *iter));
             counts[idx] += 1;
         }
 
         iter = first;
-        for (diff_type i = 0; i <= distance; ++i) {
+        for (diff_type n = 0; n <= distance; ++n) {
+            diff_type i = Descending ? (distance - n) : n;
             count_type count = counts[i];
             if (count != 0) {
                 value_type val = minVal + static_cast<value_type>(i);
@@ -133,12 +267,13 @@ inline void dense_counting_sort(Iterator first, Iterator last, Comparer compare,
 
         iterator iter;
         for (iter = first; iter < last; ++iter) {
-            value_type idx = *iter - minVal;
+            size_t idx = static_cast<size_t>(key_distance(minVal, *iter));
             counts[idx] += 1;
         }
 
         iter = first;
-        for (diff_type i = 0; i <= distance; ++i) {
+        for (diff_type n = 0; n <= distance; ++n) {
+            diff_type i = Descending ? (distance - n) : n;
             count_type count = counts[i];
             if (count != 0) {
                 value_type val = minVal + static_cast<value_type>(i);
@@ -153,13 +288,55 @@ inline void dense_counting_sort(Iterator first, Iterator last, Comparer compare,
     }
 }
 
-template <typename CountType, typename Iterator, typename Comparer,
+//
+// Write the value of a set bit of count_bits, counts[dist] times.
+//
+template <typename Iterator, typename CountType, typename ValueType>
+struct SparseCountEmitter {
+    typedef typename std::iterator_traits<Iterator>::value_type value_type;
+
+    Iterator &          iter;
+    const CountType *   counts;
+    const ValueType &   minVal;
+
+    SparseCountEmitter(Iterator & _iter, const CountType * _counts, const ValueType & _minVal)
+        : iter(_iter), counts(_counts), minVal(_minVal) {
+    }
+
+    JSTD_FORCED_INLINE
+    void operator () (size_t dist) const {
+        value_type val = minVal + static_cast<value_type>(dist);
+        CountType count = counts[dist];
+        assert(count != 0);
+        for (CountType c = 0; c < count; ++c) {
+            *iter = val;
+            ++iter;
+        }
+    }
+};
+
+//
+// Write the values of the set bits of count_bits, each one counts[dist] times,
+// from the lowest bit (Descending is false) or from the highest bit.
+// The bitmap is scanned by BitUtils::for_each_set_bit(), the zero blocks are skipped.
+//
+template <bool Descending, typename Iterator, typename CountType, typename ValueType>
+inline Iterator emit_sparse_counts(Iterator iter, const size_t * count_bits, size_t wordLen,
+                                   const CountType * counts, const ValueType & minVal) {
+    SparseCountEmitter<Iterator, CountType, ValueType> emitter(iter, counts, minVal);
+    if (Descending)
+        BitUtils::for_each_set_bit_reverse(count_bits, wordLen, emitter);
+    else
+        BitUtils::for_each_set_bit(count_bits, wordLen, emitter);
+    return iter;
+}
+
+template <typename CountType, bool Descending, typename Iterator,
           typename DiffType, typename ValueType>
-inline void sparse_counting_sort(Iterator first, Iterator last, Comparer compare,
+inline void sparse_counting_sort(Iterator first, Iterator last,
                                  DiffType distance, const ValueType & minVal) {
     typedef Iterator iterator;
     typedef typename std::make_unsigned<CountType>::type             count_type;
-    typedef typename std::iterator_traits<iterator>::value_type      value_type;
     typedef typename std::iterator_traits<iterator>::difference_type diff_type;
 
     static const size_t kFixedDistance = 65536;
@@ -174,7 +351,7 @@ inline void sparse_counting_sort(Iterator first, Iterator last, Comparer compare
     size_t maxBitsWordLen = (bitsAlignedBytes + sizeof(size_t) - 1) / sizeof(size_t);
 
     assert(distance > 0);
-    if (likely(distance < diff_type(kFixedDistance))) {
+    if (likely(distance < diff_type(kFixedDistance) && sizeof(count_type) <= sizeof(uint32_t))) {
         size_t count_bits[kFixedBitsWordLen];
         count_type counts[kFixedDistance];
         size_t maxCountWordLen = ((distance + 1) * sizeof(count_type) + sizeof(size_t) - 1) / sizeof(size_t);
@@ -185,7 +362,7 @@ inline void sparse_counting_sort(Iterator first, Iterator last, Comparer compare
 
         iterator iter;
         for (iter = first; iter < last; ++iter) {
-            value_type idx = *iter - minVal;
+            size_t idx = static_cast<size_t>(key_distance(minVal, *iter));
             count_type old_count = counts[idx];
             counts[idx] = old_count + 1;
             if (old_count == 0) {
@@ -197,23 +374,8 @@ inline void sparse_counting_sort(Iterator first, Iterator last, Comparer compare
             }
         }
 
-        iter = first;
-        for (diff_type i = 0; i < (diff_type)maxBitsWordLen; ++i) {
-            size_t mask = count_bits[i];
-            while (mask != 0) {
-                size_t bit_pos = BitUtils::bsf(mask);
-                mask ^= BitUtils::ls1b(mask);
-                size_t dist = i * kBitsPerWord + bit_pos;
-                value_type val = minVal + static_cast<value_type>(dist);
-                count_type count = counts[dist];
-                assert(count != 0);
-                for (count_type n = 0; n < count; ++n) {
-                    assert(iter != last);
-                    *iter = std::move(val);
-                    ++iter;
-                }
-            }
-        }
+        iter = emit_sparse_counts<Descending>(first, &count_bits[0], maxBitsWordLen,
+                                              &counts[0], minVal);
         assert(iter == last);
     } else {
         std::unique_ptr<size_t[]> count_bits(new size_t[maxBitsWordLen]());
@@ -221,7 +383,7 @@ inline void sparse_counting_sort(Iterator first, Iterator last, Comparer compare
 
         iterator iter;
         for (iter = first; iter < last; ++iter) {
-            value_type idx = *iter - minVal;
+            size_t idx = static_cast<size_t>(key_distance(minVal, *iter));
             count_type old_count = counts[idx];
             counts[idx] = old_count + 1;
             if (old_count == 0) {
@@ -234,25 +396,240 @@ inline void sparse_counting_sort(Iterator first, Iterator last, Comparer compare
             }
         }
 
-        iter = first;
-        for (diff_type i = 0; i < (diff_type)maxBitsWordLen; ++i) {
-            size_t mask = count_bits.get()[i];
-            while (mask != 0) {
-                size_t bit_pos = BitUtils::bsf(mask);
+        iter = emit_sparse_counts<Descending>(first, count_bits.get(), maxBitsWordLen,
+                                              counts.get(), minVal);
+        assert(iter == last);
+    }
+}
+
+struct FreeDeleter {
+    void operator () (void * ptr) const {
+        std::free(ptr);
+    }
+};
+
+//
+// The extra copies of the duplicate values of hierarchical_counting_sort(), an open addressing
+// hash map of the value index to its count of the extra copies (linear probing).
+//
+class DupCountMap {
+public:
+    static const size_t kEmptyKey = static_cast<size_t>(-1);
+    static const size_t kMinCapacity = 64;
+
+private:
+    std::unique_ptr<size_t[]> keys_;
+    std::unique_ptr<size_t[]> counts_;
+    size_t mask_;
+    size_t shift_;
+    size_t size_;
+
+public:
+    DupCountMap() : mask_(0), shift_(0), size_(0) {
+    }
+
+    size_t size() const { return size_; }
+
+    void add(size_t key) {
+        assert(key != kEmptyKey);
+        if (unlikely(mask_ == 0))
+            rehash(kMinCapacity);
+        size_t slot = hash(key);
+        while (true) {
+            size_t slotKey = keys_[slot];
+            if (slotKey == key) {
+                ++counts_[slot];
+                return;
+            }
+            if (slotKey == kEmptyKey)
+                break;
+            slot = (slot + 1) & mask_;
+        }
+
+        if (unlikely((size_ + 1) * 2 > (mask_ + 1))) {
+            rehash((mask_ + 1) * 2);
+            slot = hash(key);
+            while (keys_[slot] != kEmptyKey) {
+                slot = (slot + 1) & mask_;
+            }
+        }
+        keys_[slot] = key;
+        counts_[slot] = 1;
+        ++size_;
+    }
+
+    size_t count(size_t key) const {
+        assert(size_ != 0);
+        size_t slot = hash(key);
+        while (true) {
+            size_t slotKey = keys_[slot];
+            if (slotKey == key)
+                return counts_[slot];
+            if (slotKey == kEmptyKey)
+                return 0;
+            slot = (slot + 1) & mask_;
+        }
+    }
+
+private:
+    // Fibonacci hashing, the top bits of the product.
+    size_t hash(size_t key) const {
+        static const size_t kGoldenRatio = (sizeof(size_t) == 8) ?
+                                           static_cast<size_t>(0x9E3779B97F4A7C15ull) :
+                                           static_cast<size_t>(0x9E3779B9ul);
+        return ((key * kGoldenRatio) >> shift_);
+    }
+
+    void rehash(size_t capacity) {
+        std::unique_ptr<size_t[]> oldKeys(std::move(keys_));
+        std::unique_ptr<size_t[]> oldCounts(std::move(counts_));
+        size_t oldCapacity = (mask_ != 0) ? (mask_ + 1) : 0;
+
+        keys_.reset(new size_t[capacity]);
+        counts_.reset(new size_t[capacity]);
+        std::fill_n(keys_.get(), capacity, static_cast<size_t>(kEmptyKey));
+        mask_  = capacity - 1;
+        shift_ = sizeof(size_t) * 8 - BitUtils::bsf(capacity);
+
+        for (size_t i = 0; i < oldCapacity; i++) {
+            size_t key = oldKeys[i];
+            if (key != kEmptyKey) {
+                size_t slot = hash(key);
+                while (keys_[slot] != kEmptyKey) {
+                    slot = (slot + 1) & mask_;
+                }
+                keys_[slot] = key;
+                counts_[slot] = oldCounts[i];
+            }
+        }
+    }
+};
+
+//
+// Write the values of the set bits of a word of the value bitmap, the words which have
+// the duplicate values are marked in the duplicate bitmap, their extra copies are counted
+// in the duplicate map.
+//
+template <bool Descending, typename Iterator, typename ValueType>
+struct HierarchicalEmitter {
+    typedef typename std::iterator_traits<Iterator>::value_type value_type;
+
+    static const size_t kBitsPerWord = sizeof(size_t) * 8;
+    static const size_t kShiftPerWord = (sizeof(size_t) == 8) ? 6 : 5;
+
+    Iterator &          iter;
+    const size_t *      value_bits;
+    const size_t *      dup_bits;
+    const DupCountMap & dup_counts;
+    const ValueType &   minVal;
+
+    HierarchicalEmitter(Iterator & _iter, const size_t * _value_bits, const size_t * _dup_bits,
+                        const DupCountMap & _dup_counts, const ValueType & _minVal)
+        : iter(_iter), value_bits(_value_bits), dup_bits(_dup_bits),
+          dup_counts(_dup_counts), minVal(_minVal) {
+    }
+
+    JSTD_FORCED_INLINE
+    void operator () (size_t word) const {
+        size_t mask = value_bits[word];
+        assert(mask != 0);
+        bool has_dups = (((dup_bits[word >> kShiftPerWord] >> (word & (kBitsPerWord - 1))) & 1) != 0);
+        while (mask != 0) {
+            size_t bit_pos;
+            if (Descending) {
+                bit_pos = BitUtils::bsr(mask);
+                mask ^= size_t(1) << bit_pos;
+            } else {
+                bit_pos = BitUtils::bsf(mask);
                 mask ^= BitUtils::ls1b(mask);
-                size_t dist = i * kBitsPerWord + bit_pos;
-                count_type count = counts[dist];
-                value_type val = minVal + static_cast<value_type>(dist);
-                assert(count != 0);
-                for (count_type n = 0; n < count; ++n) {
-                    assert(iter != last);
-                    *iter = std::move(val);
+            }
+            size_t dist = word * kBitsPerWord + bit_pos;
+            value_type val = minVal + static_cast<value_type>(dist);
+            *iter = val;
+            ++iter;
+            if (unlikely(has_dups)) {
+                size_t count = dup_counts.count(dist);
+                for (size_t i = 0; i < count; i++) {
+                    *iter = val;
                     ++iter;
                 }
             }
         }
-        assert(iter == last);
     }
+};
+
+//
+// The counting sort of the wide ranges, length * kHierarchicalMinDistanceRatio < distance
+// <= length * kHierarchicalMaxDistanceRatio.
+//
+// A value bitmap has a bit per value, a summary bitmap has a bit per word of the value
+// bitmap. The value bitmap is allocated by calloc(), the pages never written are not
+// touched, the emit scans the summary bitmap and only reads the occupied words.
+// The counts are not kept: the extra copies of a value are counted in a small hash map
+// (DupCountMap), the words which have them are marked in a duplicate bitmap, so the memory
+// doesn't scale with the counts of the range.
+//
+// Returns false if the bitmaps can't be allocated, or if more than 1 / kHierarchicalMaxDupRatio
+// of the scanned values are the extra copies, the hash map would be slower than proxmap_sort().
+// It's checked while scanning, the duplicate heavy inputs are rejected early.
+// The input is not changed until the emit, the caller falls back to proxmap_sort().
+//
+template <bool Descending, typename Iterator, typename DiffType, typename ValueType>
+inline bool hierarchical_counting_sort(Iterator first, Iterator last,
+                                       DiffType distance, const ValueType & minVal) {
+    typedef Iterator iterator;
+
+    static const size_t kBitsPerWord = sizeof(size_t) * 8;
+    static const size_t kShiftPerWord = (sizeof(size_t) == 8) ? 6 : 5;
+
+    assert(distance > 0);
+    size_t valueWordLen   = ((size_t)distance + kBitsPerWord) / kBitsPerWord;
+    size_t summaryWordLen = (valueWordLen + kBitsPerWord - 1) / kBitsPerWord;
+
+    std::unique_ptr<size_t[], FreeDeleter> value_bits(
+        static_cast<size_t *>(std::calloc(valueWordLen, sizeof(size_t))));
+    std::unique_ptr<size_t[], FreeDeleter> summary_bits(
+        static_cast<size_t *>(std::calloc(summaryWordLen, sizeof(size_t))));
+    std::unique_ptr<size_t[], FreeDeleter> dup_word_bits(
+        static_cast<size_t *>(std::calloc(summaryWordLen, sizeof(size_t))));
+    if (value_bits.get() == nullptr || summary_bits.get() == nullptr ||
+        dup_word_bits.get() == nullptr)
+        return false;
+
+    size_t * values  = value_bits.get();
+    size_t * summary = summary_bits.get();
+    size_t * dups    = dup_word_bits.get();
+    DupCountMap dup_counts;
+    size_t dupCount = 0;
+
+    for (iterator iter = first; iter < last; ++iter) {
+        size_t idx  = static_cast<size_t>(key_distance(minVal, *iter));
+        size_t word = idx >> kShiftPerWord;
+        size_t mask = size_t(1) << (idx & (kBitsPerWord - 1));
+        size_t word_mask = size_t(1) << (word & (kBitsPerWord - 1));
+        assert(word < valueWordLen);
+        size_t bits = values[word];
+        if (likely((bits & mask) == 0)) {
+            values[word] = bits | mask;
+            summary[word >> kShiftPerWord] |= word_mask;
+        } else {
+            size_t scanned = static_cast<size_t>(iter - first) + kHierarchicalMinDupScan;
+            if (unlikely(++dupCount * kHierarchicalMaxDupRatio > scanned))
+                return false;
+            dup_counts.add(idx);
+            dups[word >> kShiftPerWord] |= word_mask;
+        }
+    }
+
+    iterator iter = first;
+    HierarchicalEmitter<Descending, iterator, ValueType> emitter(iter, values, dups,
+                                                                 dup_counts, minVal);
+    if (Descending)
+        BitUtils::for_each_set_bit_reverse(summary, summaryWordLen, emitter);
+    else
+        BitUtils::for_each_set_bit(summary, summaryWordLen, emitter);
+    assert(iter == last);
+    return true;
 }
 
 template <typename DiffType>
@@ -266,60 +643,364 @@ inline size_t calc_shift_factor(DiffType length, DiffType distance) {
         assert(distanceBits >= lengthBits);
         size_t shiftBits = distanceBits - lengthBits;
         if (length > DiffType(65536 * 8)) {
-            debug_print("length = %u, distance = %u\n",
-                        (uint32_t)length, (uint32_t)distance);
+            debug_print("length = %llu, distance = %llu\n",
+                        (unsigned long long)length, (unsigned long long)distance);
             debug_print("lengthBits = %u, distanceBits = %u, shiftBits = %u\n",
                         (uint32_t)lengthBits, (uint32_t)distanceBits, (uint32_t)shiftBits);
         }
-        // (length * shiftFactor * 1.5) > distance ?
-        size_t ll = length << shiftBits;
-        shiftBits += ((ll + (ll >> 1)) > (size_t)distance);
+        // (length * shiftFactor * 1.5) > distance ? without the overflow of ll * 1.5.
+        size_t ll = (size_t)length << shiftBits;
+        shiftBits += (ll > (size_t)distance || ((size_t)distance - ll) < (ll >> 1));
         return shiftBits;
     } else {
         return 0;
     }
 }
 
+//
+// The bucket table of proxmap_sort() is read and written randomly, it's kept in half of L2.
+//
+inline size_t proxmap_max_bucket_count(size_t bucket_size) {
+    size_t maxBuckets = CacheInfo::get().l2_size / 2 / bucket_size;
+    maxBuckets = (maxBuckets > kMinBucketCount) ? maxBuckets : kMinBucketCount;
+    maxBuckets = (maxBuckets < kMaxBucketCount) ? maxBuckets : kMaxBucketCount;
+    return maxBuckets;
+}
+
+//
+// The scatter of a MSD level writes to a line per bucket: the buckets are bounded by
+// the lines of L1 and the pages of the data TLB, so the write heads stay in both.
+//
+inline size_t msd_max_bucket_count() {
+    const CacheInfo & cache = CacheInfo::get();
+    size_t l1Lines = cache.l1d_size / cache.line_size;
+    size_t maxBuckets = (cache.dtlb_entries * 16 < l1Lines) ? (cache.dtlb_entries * 16) : l1Lines;
+    maxBuckets = (maxBuckets > kMinBucketCount) ? maxBuckets : kMinBucketCount;
+    return maxBuckets;
+}
+
 template <typename DiffType>
-inline std::pair<size_t, size_t> calc_bucket_count(DiffType length, DiffType distance) {
-    static const size_t kMaxBucketSize = 256 * 1024;
-    static const size_t kMaxLengthBits = 18;
+inline std::pair<size_t, size_t> calc_bucket_count(DiffType length, DiffType distance,
+                                                   size_t maxBucketCount) {
     size_t shiftBits   = calc_shift_factor(length, distance);
     size_t shiftFactor = size_t(1) << shiftBits;
-    size_t bucketCount = (((size_t)distance + 1) + (shiftFactor - 1)) >> shiftBits;
+    size_t bucketCount = ((size_t)distance >> shiftBits) + 1;
     assert(bucketCount >= 2);
     if (length > DiffType(65536 * 8)) {
-        debug_print("length = %u, distance = %u\n",
-                    (uint32_t)length, (uint32_t)distance);
-        debug_print("shiftBits = %u, shiftFactor = 0x%08X, bucketCount = %u\n",
-                    (uint32_t)shiftBits, (uint32_t)shiftFactor, (uint32_t)bucketCount);
+        debug_print("length = %llu, distance = %llu\n",
+                    (unsigned long long)length, (unsigned long long)distance);
+        debug_print("shiftBits = %u, shiftFactor = 0x%llX, bucketCount = %llu\n",
+                    (uint32_t)shiftBits, (unsigned long long)shiftFactor,
+                    (unsigned long long)bucketCount);
     }
-    if (bucketCount > kMaxBucketSize) {
-        // If bucketCount is bigger than kMaxBucketSize,
+    if (bucketCount > maxBucketCount) {
+        // If bucketCount is bigger than maxBucketCount,
         // recalculate the shiftBits, shiftFactor and bucketCount,
-        // let the size of bucketCount approach kMaxBucketSize.
-        shiftFactor = (((size_t)distance + 1) + (kMaxBucketSize - 1)) / kMaxBucketSize;
+        // let the size of bucketCount approach maxBucketCount.
+        shiftFactor = (((size_t)distance + 1) + (maxBucketCount - 1)) / maxBucketCount;
         shiftBits = jstd::pow2::log2_int<size_t, 2>(shiftFactor);
         shiftFactor = size_t(1) << shiftBits;
-        bucketCount = (((size_t)distance + 1) + (shiftFactor - 1)) >> shiftBits;
-        debug_print(">> length = %u, distance = %u\n",
-                    (uint32_t)length, (uint32_t)distance);
-        debug_print(">> shiftBits = %u, shiftFactor = 0x%08X, bucketCount = %u\n",
-                    (uint32_t)shiftBits, (uint32_t)shiftFactor, (uint32_t)bucketCount);
+        bucketCount = ((size_t)distance >> shiftBits) + 1;
+        debug_print(">> length = %llu, distance = %llu\n",
+                    (unsigned long long)length, (unsigned long long)distance);
+        debug_print(">> shiftBits = %u, shiftFactor = 0x%llX, bucketCount = %llu\n",
+                    (uint32_t)shiftBits, (unsigned long long)shiftFactor,
+                    (unsigned long long)bucketCount);
     }
     return std::make_pair(bucketCount, shiftBits);
 }
 
+//
+// The offsets of the levels of msd_histogram_sort(), a table per recursion depth, allocated
+// on the first use and reused by all the buckets of that depth, the recursion doesn't
+// allocate per bucket. A level has at most msd_max_bucket_count() buckets.
+//
+class MsdOffsets {
+private:
+    std::vector<std::unique_ptr<size_t[]>> levels_;
+    size_t max_buckets_;
+
+public:
+    MsdOffsets() : max_buckets_(msd_max_bucket_count()) {
+    }
+
+    size_t max_bucket_count() const { return max_buckets_; }
+
+    size_t * level(size_t depth) {
+        while (levels_.size() <= depth) {
+            levels_.emplace_back(new size_t[max_buckets_ + 1]);
+        }
+        return levels_[depth].get();
+    }
+};
+
+//
+// The MSD histogram sort of a bucket: the bucket is split by the key range of its values
+// to at most msd_max_bucket_count() buckets, scattered to the buffer and moved back,
+// then the buckets are sorted by insertion sort or recursively. The buffer has
+// (last - first) values. It's stable.
+//
+template <typename Iterator, typename Order>
+inline void msd_histogram_sort(Iterator first, Iterator last,
+                               typename std::iterator_traits<Iterator>::value_type * buffer,
+                               const Order & order, MsdOffsets & levels, size_t depth = 0) {
+    typedef Iterator iterator;
+    typedef typename std::iterator_traits<iterator>::difference_type diff_type;
+    typedef typename Order::key_type                                 key_type;
+
+    diff_type length = last - first;
+    if (likely((size_t)length <= kMsdInsertSortThreshold)) {
+        jstd::insert_sort(first, last, order);
+        return;
+    }
+
+    key_type minKey = order.key(*first);
+    key_type maxKey = minKey;
+    for (iterator iter = std::next(first); iter < last; ++iter) {
+        key_type key = order.key(*iter);
+        minKey = (key < minKey) ? key : minKey;
+        maxKey = (key > maxKey) ? key : maxKey;
+    }
+    size_t distance = static_cast<size_t>(key_distance(minKey, maxKey));
+    if (distance == 0)
+        return;
+
+    // About a bucket per value, at most msd_max_bucket_count().
+    size_t maxBuckets = levels.max_bucket_count();
+    size_t targetBuckets = ((size_t)length < maxBuckets) ? (size_t)length : maxBuckets;
+    size_t shiftBits = jstd::pow2::log2_int<size_t>(distance / targetBuckets + 1);
+    size_t bucketCount = (distance >> shiftBits) + 1;
+    assert(bucketCount <= maxBuckets);
+
+    size_t * offsets = levels.level(depth);
+    std::fill_n(offsets, bucketCount + 1, size_t(0));
+    for (iterator iter = first; iter < last; ++iter) {
+        size_t index = order.offset(*iter, minKey, maxKey) >> shiftBits;
+        ++offsets[index + 1];
+    }
+    for (size_t i = 1; i <= bucketCount; i++) {
+        offsets[i] += offsets[i - 1];
+    }
+
+    for (iterator iter = first; iter < last; ++iter) {
+        size_t index = order.offset(*iter, minKey, maxKey) >> shiftBits;
+        buffer[offsets[index]++] = std::move(*iter);
+    }
+    std::move(buffer, buffer + length, first);
+
+    // offsets[i] is the end of bucket i now.
+    size_t start = 0;
+    for (size_t i = 0; i < bucketCount; i++) {
+        size_t end = offsets[i];
+        if ((end - start) > 1) {
+            msd_histogram_sort(first + start, first + end, buffer + start, order,
+                               levels, depth + 1);
+        }
+        start = end;
+    }
+}
+
+//
+// The sampler of the sample sort and the skew check, a xorshift64, seeded by the length,
+// the same array is sampled the same way.
+//
+struct SampleRandom {
+    uint64_t state;
+
+    explicit SampleRandom(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {}
+
+    size_t next(size_t bound) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return static_cast<size_t>(state % bound);
+    }
+};
+
+//
+// Classify the key offsets to 2 * kBuckets buckets by kBuckets - 1 sorted splitters, without
+// branches (Super Scalar Sample Sort): the splitters are kept as a complete binary search tree
+// in the heap order (the children of node i are 2 * i and 2 * i + 1), a key walks down
+// kSplitterTreeDepth levels by the compares.
+// The bucket 2 * b has the keys in (splitters[b - 1], splitters[b]), the bucket 2 * b + 1 is
+// the equality bucket of splitters[b], its keys are all equal, it's not sorted again.
+//
+struct SplitterTree {
+    static const size_t kBuckets = size_t(1) << kSplitterTreeDepth;
+
+    size_t tree[kBuckets];
+    size_t splitters[kBuckets];
+
+    // The splitters are sorted and unique, 0 < count < kBuckets.
+    SplitterTree(const size_t * sorted, size_t count) {
+        assert(count > 0 && count < kBuckets);
+        for (size_t i = 0; i < kBuckets - 1; i++) {
+            // The last splitter is repeated, the buckets after it are empty.
+            splitters[i] = sorted[(i < count) ? i : (count - 1)];
+        }
+        // Never equal to a key offset.
+        splitters[kBuckets - 1] = static_cast<size_t>(-1);
+        build(1, 0, kBuckets - 1);
+    }
+
+    JSTD_FORCED_INLINE
+    size_t classify(size_t offset) const {
+        size_t i = 1;
+        for (size_t level = 0; level < kSplitterTreeDepth; level++) {
+            i = 2 * i + static_cast<size_t>(offset > tree[i]);
+        }
+        size_t bucket = i - kBuckets;
+        return (2 * bucket + static_cast<size_t>(offset == splitters[bucket]));
+    }
+
+private:
+    void build(size_t node, size_t lo, size_t hi) {
+        if (node >= kBuckets)
+            return;
+        size_t mid = lo + (hi - lo) / 2;
+        tree[node] = splitters[mid];
+        build(2 * node, lo, mid);
+        build(2 * node + 1, mid + 1, hi);
+    }
+};
+
+//
+// Check the proxmap buckets of a sample: a few buckets have most of the values (Zipf,
+// clusters) if a bucket has kSkewSampleMaxCount of the kSkewSampleSize sampled values.
+//
+template <typename Iterator, typename Order, typename DiffType, typename KeyType>
+inline bool sample_is_skewed(Iterator first, const Order & order, DiffType length,
+                             const KeyType & minKey, const KeyType & maxKey, size_t shiftBits) {
+    size_t sample[kSkewSampleSize];
+    SampleRandom random(static_cast<uint64_t>(length));
+    for (size_t i = 0; i < kSkewSampleSize; i++) {
+        size_t index = random.next(static_cast<size_t>(length));
+        sample[i] = order.offset(*(first + index), minKey, maxKey) >> shiftBits;
+    }
+    std::sort(&sample[0], &sample[0] + kSkewSampleSize);
+
+    size_t run = 1;
+    for (size_t i = 1; i < kSkewSampleSize; i++) {
+        run = (sample[i] == sample[i - 1]) ? (run + 1) : 1;
+        if (run >= kSkewSampleMaxCount)
+            return true;
+    }
+    return false;
+}
+
+//
+// The sample sort mode of proxmap_sort() for the skewed keys: the splitters are picked at
+// the equal distances from a sorted random sample, so each bucket gets about the same count
+// whatever the distribution is. The values are classified by SplitterTree, scattered to
+// the buffer and moved back, then the buckets (except the equality buckets) are sorted by
+// msd_histogram_sort(). It's stable.
+//
+// The values are classified a block at a time. Up to kSampleSortMaxBucketIds values,
+// the bucket ids of all the values are kept for the scatter (2 bytes per value). Beyond it,
+// only the ids of a block are kept, the scatter classifies the values again, so the extra
+// memory is the buffer of length values, the same as proxmap_sort().
+//
+template <typename Iterator, typename Order, typename DiffType, typename KeyType>
+inline void sample_sort(Iterator first, Iterator last, const Order & order,
+                        DiffType length, const KeyType & minKey, const KeyType & maxKey) {
+    typedef Iterator iterator;
+    typedef typename std::iterator_traits<iterator>::value_type value_type;
+
+    static const size_t kBuckets = SplitterTree::kBuckets;
+    static const size_t kSampleSize = kBuckets * kSampleOversampling;
+
+    assert((size_t)length >= kSampleSortMinLength);
+
+    std::unique_ptr<size_t[]> sample(new size_t[kSampleSize]);
+    SampleRandom random(static_cast<uint64_t>(length) ^ 0x5A5A5A5Aull);
+    for (size_t i = 0; i < kSampleSize; i++) {
+        size_t index = random.next(static_cast<size_t>(length));
+        sample[i] = order.offset(*(first + index), minKey, maxKey);
+    }
+    std::sort(sample.get(), sample.get() + kSampleSize);
+
+    // The equidistant splitters, the repeated ones are merged to an equality bucket.
+    size_t splitters[kBuckets];
+    size_t splitterCount = 0;
+    for (size_t i = 1; i < kBuckets; i++) {
+        size_t splitter = sample[i * kSampleOversampling];
+        if (splitterCount == 0 || splitter != splitters[splitterCount - 1])
+            splitters[splitterCount++] = splitter;
+    }
+    SplitterTree splitterTree(splitters, splitterCount);
+
+    bool keepIds = ((size_t)length <= kSampleSortMaxBucketIds);
+    std::unique_ptr<uint16_t[]> bucketIds(
+        new uint16_t[keepIds ? (size_t)length : kSampleSortBlockSize]);
+    size_t offsets[kBuckets * 2 + 1];
+    std::memset(offsets, 0, sizeof(offsets));
+
+    size_t n = 0;
+    for (iterator block = first; block < last; ) {
+        size_t blockSize = (std::min)(static_cast<size_t>(last - block), kSampleSortBlockSize);
+        uint16_t * ids = bucketIds.get() + (keepIds ? n : 0);
+        iterator iter = block;
+        for (size_t i = 0; i < blockSize; ++i, ++iter) {
+            size_t bucket = splitterTree.classify(order.offset(*iter, minKey, maxKey));
+            ids[i] = static_cast<uint16_t>(bucket);
+            ++offsets[bucket + 1];
+        }
+        block = iter;
+        n += blockSize;
+    }
+    for (size_t i = 1; i <= kBuckets * 2; i++) {
+        offsets[i] += offsets[i - 1];
+    }
+
+    std::unique_ptr<value_type[]> buffer(new value_type[length]);
+    n = 0;
+    for (iterator block = first; block < last; ) {
+        size_t blockSize = (std::min)(static_cast<size_t>(last - block), kSampleSortBlockSize);
+        uint16_t * ids = bucketIds.get() + (keepIds ? n : 0);
+        iterator iter = block;
+        if (!keepIds) {
+            for (size_t i = 0; i < blockSize; ++i, ++iter) {
+                ids[i] = static_cast<uint16_t>(
+                    splitterTree.classify(order.offset(*iter, minKey, maxKey)));
+            }
+            iter = block;
+        }
+        for (size_t i = 0; i < blockSize; ++i, ++iter) {
+            buffer[offsets[ids[i]]++] = std::move(*iter);
+        }
+        block = iter;
+        n += blockSize;
+    }
+    std::move(buffer.get(), buffer.get() + length, first);
+
+    // offsets[i] is the end of bucket i now.
+    MsdOffsets msdLevels;
+    size_t start = 0;
+    for (size_t i = 0; i < kBuckets * 2; i += 2) {
+        size_t end = offsets[i];
+        if ((end - start) > 1)
+            msd_histogram_sort(first + start, first + end, buffer.get() + start, order, msdLevels);
+        start = offsets[i + 1];
+    }
+}
+
 //
 // Histogram sort & Proxmap sort
 //
 // See: https://zh.wikipedia.org/zh-cn/%E6%8F%92%E5%80%BC%E6%8E%92%E5%BA%8F
 //
-template <typename CountType, typename Iterator, typename Comparer,
-          typename DiffType, typename ValueType>
-inline void proxmap_sort(Iterator first, Iterator last, Comparer compare,
+// If a sample shows the skewed keys, it's sorted by sample_sort().
+//
+// The bucket table is bounded by L2 (proxmap_max_bucket_count()). If every bucket has at most
+// kProxmapMaxInsertCount values, the values are placed by insertion into their buckets.
+// Else (the skewed keys) the values are scattered to the buckets, then each bucket is sorted
+// by msd_histogram_sort(), the insertion doesn't degrade to O(n^2) in the crowded buckets.
+//
+template <typename CountType, typename Iterator, typename Order,
+          typename DiffType, typename KeyType>
+inline void proxmap_sort(Iterator first, Iterator last, const Order & order,
                          DiffType length, DiffType distance,
-                         const ValueType & minVal, const ValueType & maxVal) {
+                         const KeyType & minKey, const KeyType & maxKey) {
     typedef Iterator iterator;
     typedef typename std::make_unsigned<CountType>::type        count_type;
     typedef typename std::iterator_traits<iterator>::value_type value_type;
@@ -330,31 +1011,31 @@ inline void proxmap_sort(Iterator first, Iterator last, Comparer compare,
     assert(length > kStdSortThreshold);
     assert(distance > 0);
 
-    std::pair<size_t, size_t> shiftData = calc_bucket_count(length, distance);
+    std::pair<size_t, size_t> shiftData = calc_bucket_count(length, distance,
+                                              proxmap_max_bucket_count(sizeof(bucket_type)));
     size_t bucketCount = shiftData.first;
     size_t shiftBits   = shiftData.second;
 
+    if ((size_t)length >= kSampleSortMinLength &&
+        sample_is_skewed(first, order, length, minKey, maxKey, shiftBits)) {
+        sample_sort(first, last, order, length, minKey, maxKey);
+        return;
+    }
+
     std::unique_ptr<bucket_type[]> buckets(new bucket_type[bucketCount]());
     for (iterator iter = first; iter < last; ++iter) {
-        size_t index = static_cast<size_t>(*iter - minVal) >> shiftBits;
+        size_t index = order.offset(*iter, minKey, maxKey) >> shiftBits;
         ++buckets[index].first;
     }
 
     size_t total = 0;
-    size_t min_count = 65535, max_count = 0;
+    size_t max_count = 0;
     for (size_t i = 0; i < bucketCount; i++) {
         size_t old_count = buckets[i].first;
-#if 0
-        count_type value = (old_count != 0) ? static_cast<count_type>(total) : kEmptyBucket;
-        buckets[i].first = value;
-        buckets[i].last  = value;
-        total += old_count;
-#else
         if (old_count != 0) {
             buckets[i].first = static_cast<count_type>(total);
             buckets[i].last  = static_cast<count_type>(total);
             total += old_count;
-            min_count = (old_count < min_count) ? old_count : min_count;
             max_count = (old_count > max_count) ? old_count : max_count;
         } else {
 #ifdef _DEBUG
@@ -362,14 +1043,13 @@ inline void proxmap_sort(Iterator first, Iterator last, Comparer compare,
             buckets[i].last  = kEmptyBucket;
 #endif
         }
-#endif
     }
 
-    {
-        std::unique_ptr<value_type[]> sortedArray(new value_type[length]);
+    std::unique_ptr<value_type[]> sortedArray(new value_type[length]);
 
+    if (likely(max_count <= kProxmapMaxInsertCount)) {
         for (iterator iter = first; iter < last; ++iter) {
-            size_t bucketIndex = static_cast<size_t>(*iter - minVal) >> shiftBits;
+            size_t bucketIndex = order.offset(*iter, minKey, maxKey) >> shiftBits;
             count_type insertFirst = buckets[bucketIndex].first;
             count_type insertLast  = buckets[bucketIndex].last;
             assert(insertFirst != kEmptyBucket);
@@ -380,12 +1060,12 @@ inline void proxmap_sort(Iterator first, Iterator last, Comparer compare,
             value_type * insert = &sortedArray[insertLast];
             if (likely(insertFirst != insertLast)) {
                 value_type * target = std::prev(insert);
-                if (compare(*iter, *target)) {
+                if (order(*iter, *target)) {
                     value_type * start = &sortedArray[insertFirst];
                     do {
                         *insert = std::move(*target);
                         --insert;
-                    } while (insert > start && compare(*iter, *--target));
+                    } while (insert > start && order(*iter, *--target));
                 }
             }
             *insert = std::move(*iter);
@@ -395,95 +1075,203 @@ inline void proxmap_sort(Iterator first, Iterator last, Comparer compare,
         for (iterator iter = first; iter < last; ++sorted, ++iter) {
             *iter = std::move(*sorted);
         }
+    } else {
+        for (iterator iter = first; iter < last; ++iter) {
+            size_t bucketIndex = order.offset(*iter, minKey, maxKey) >> shiftBits;
+            assert(buckets[bucketIndex].first != kEmptyBucket);
+            sortedArray[buckets[bucketIndex].last++] = std::move(*iter);
+        }
+        std::move(&sortedArray[0], &sortedArray[0] + length, first);
+
+        MsdOffsets msdLevels;
+        for (size_t i = 0; i < bucketCount; i++) {
+            // The last bucket may end at 65536, the count doesn't overflow,
+            // the min key and the max key are not in the same bucket.
+            size_t start = buckets[i].first;
+            size_t count = static_cast<count_type>(buckets[i].last - buckets[i].first);
+            if (likely(count <= 1))
+                continue;
+            msd_histogram_sort(first + start, first + (start + count), &sortedArray[start], order,
+                               msdLevels);
+        }
     }
 }
 
-template <typename RandomAccessIter, typename Comparer>
+//
+// The keys span more than diff_type (the 64-bit keys), the distance can't be counted.
+//
+template <typename Iterator, typename Order, typename DiffType, typename KeyType>
+inline void wide_key_sort(Iterator first, Iterator last, const Order & order,
+                          DiffType length, const KeyType & minKey, const KeyType & maxKey) {
+    typedef typename std::iterator_traits<Iterator>::value_type value_type;
+
+    if ((size_t)length >= kSampleSortMinLength) {
+        sample_sort(first, last, order, length, minKey, maxKey);
+    } else {
+        std::unique_ptr<value_type[]> buffer(new value_type[length]);
+        MsdOffsets msdLevels;
+        msd_histogram_sort(first, last, buffer.get(), order, msdLevels);
+    }
+}
+
+//
+// The counting sorts rebuild the values from the keys, only for IdentityKey.
+//
+template <typename CountType, typename Iterator, typename Order,
+          typename DiffType, typename KeyType>
+inline void counting_sort(Iterator first, Iterator last, const Order & order,
+                          DiffType length, DiffType distance,
+                          const KeyType & minKey, const KeyType & maxKey, std::true_type) {
+    if (likely(distance < DiffType(65536 * 8))) {
+        if (likely(distance <= (length * 5 / 4))) {
+            dense_counting_sort<CountType, Order::kDescending>(first, last, distance, minKey);
+            return;
+        } else if (likely(distance <= (length * DiffType(kSparseMaxDistanceRatio)))) {
+            sparse_counting_sort<CountType, Order::kDescending>(first, last, distance, minKey);
+            return;
+        }
+    } else if (distance <= (length * DiffType(kWideDenseMaxDistanceRatio))) {
+        dense_counting_sort<CountType, Order::kDescending>(first, last, distance, minKey);
+        return;
+    } else if ((distance / DiffType(kHierarchicalMinDistanceRatio)) >= length &&
+               (distance / DiffType(kHierarchicalMaxDistanceRatio)) < length) {
+        if (hierarchical_counting_sort<Order::kDescending>(first, last, distance, minKey))
+            return;
+    }
+    proxmap_sort<CountType>(first, last, order, length, distance, minKey, maxKey);
+}
+
+template <typename CountType, typename Iterator, typename Order,
+          typename DiffType, typename KeyType>
+inline void counting_sort(Iterator first, Iterator last, const Order & order,
+                          DiffType length, DiffType distance,
+                          const KeyType & minKey, const KeyType & maxKey, std::false_type) {
+    proxmap_sort<CountType>(first, last, order, length, distance, minKey, maxKey);
+}
+
+template <typename SmallSorter, typename RandomAccessIter, typename Order>
 inline void histogram_sort(RandomAccessIter first, RandomAccessIter last,
-                           Comparer compare, std::random_access_iterator_tag) {
+                           const Order & order, std::random_access_iterator_tag) {
     typedef RandomAccessIter iterator;
-    typedef typename std::iterator_traits<iterator>::value_type      value_type;
     typedef typename std::iterator_traits<iterator>::difference_type diff_type;
-
-    static const size_t kMaxWordBits = sizeof(size_t) * 8;
+    typedef typename Order::key_type                                 key_type;
+    typedef std::integral_constant<bool, Order::kIdentity>           identity_type;
 
     diff_type length = last - first;
     if (likely((size_t)length <= kStdSortThreshold)) {
         if (likely((size_t)length <= kInsertSortThreshold))
-            jstd::insert_sort(first, last, compare);
+            SmallSorter::sort(first, last, order);
         else
-            std::sort(first, last, compare);
+            std::sort(first, last, order);
     } else {
         assert(length > 0);
-        value_type minVal = *first;
-        value_type maxVal = *first;
+        key_type minKey = order.key(*first);
+        key_type maxKey = minKey;
         for (iterator iter = std::next(first); iter < last; ++iter) {
+            key_type key = order.key(*iter);
 #if 1
-            minVal = (*iter < minVal) ? *iter : minVal;
-            maxVal = (*iter > maxVal) ? *iter : maxVal;
+            minKey = (key < minKey) ? key : minKey;
+            maxKey = (key > maxKey) ? key : maxKey;
 #else
-            if (*iter < minVal) minVal = *iter;
-            if (*iter > maxVal) maxVal = *iter;
+            if (key < minKey) minKey = key;
+            if (key > maxKey) maxKey = key;
 #endif
         }
 
-        diff_type distance = static_cast<diff_type>(maxVal - minVal);
+        uint64_t keyDistance = key_distance(minKey, maxKey);
+        if (unlikely(keyDistance > uint64_t((std::numeric_limits<diff_type>::max)()))) {
+            // The keys span more than diff_type, the splitters of the sample sort
+            // and the MSD levels don't depend on the distance.
+            wide_key_sort(first, last, order, length, minKey, maxKey);
+            return;
+        }
+
+        diff_type distance = static_cast<diff_type>(keyDistance);
         if (likely(distance != 0)) {
             if (likely(length <= 65536)) {
                 // Short array [0, 65536]
-                if (likely(distance < diff_type(65536 * 8))) {
-                    if (likely(distance <= (length * 5 / 4)))
-                        dense_counting_sort<uint16_t>(first, last, compare, distance, minVal);
-                    else if (likely(distance <= (length * diff_type(kMaxWordBits))))
-                        sparse_counting_sort<uint16_t>(first, last, compare, distance, minVal); 
-                    else
-                        goto ProxmapSort16;
-                } else {
-ProxmapSort16:
-                    proxmap_sort<uint16_t>(first, last, compare, length, distance, minVal, maxVal);
-                }
+                counting_sort<uint16_t>(first, last, order, length, distance,
+                                        minKey, maxKey, identity_type());
+            } else if (likely(uint64_t(length) <= uint64_t(0xFFFFFFFFu))) {
+                // Long array (65536, UInt32Max]
+                counting_sort<uint32_t>(first, last, order, length, distance,
+                                        minKey, maxKey, identity_type());
             } else {
-                // Long array (65536, UInt32Max or UInt64Max]
-                if (likely(distance < diff_type(65536 * 8))) {
-                    if (likely(distance <= (length * 5 / 4)))
-                        dense_counting_sort<uint32_t>(first, last, compare, distance, minVal);    
-                    else if (likely(distance <= (length * diff_type(kMaxWordBits))))
-                        sparse_counting_sort<uint32_t>(first, last, compare, distance, minVal);
-                    else
-                        goto ProxmapSort32;
-                } else {
-ProxmapSort32:
-                    proxmap_sort<uint32_t>(first, last, compare, length, distance, minVal, maxVal);
-                }
+                // Huge array (UInt32Max, UInt64Max]
+                counting_sort<uint64_t>(first, last, order, length, distance,
+                                        minKey, maxKey, identity_type());
             }
         }
     }
 }
 
-template <typename BiDirectionalIter, typename Comparer>
+template <typename SmallSorter, typename BiDirectionalIter, typename Order>
 inline void histogram_sort(BiDirectionalIter first, BiDirectionalIter last,
-                           Comparer compare, std::bidirectional_iterator_tag) {
+                           const Order & order, std::bidirectional_iterator_tag) {
     typedef BiDirectionalIter iterator;
     typedef typename std::iterator_traits<iterator>::iterator_category iterator_category;
     static_assert(!std::is_same<iterator_category, std::bidirectional_iterator_tag>::value,
                   "histogram_detail::histogram_sort() is not supported std::bidirectional_iterator.");
 }
 
-template <typename ForwardIter, typename Comparer>
+template <typename SmallSorter, typename ForwardIter, typename Order>
 inline void histogram_sort(ForwardIter first, ForwardIter last,
-                           Comparer compare, std::forward_iterator_tag) {
+                           const Order & order, std::forward_iterator_tag) {
     typedef ForwardIter iterator;
     typedef typename std::iterator_traits<iterator>::iterator_category iterator_category;
     static_assert(!std::is_same<iterator_category, std::forward_iterator_tag>::value,
                   "histogram_detail::histogram_sort() is not supported std::forward_iterator.");
 }
 
+//
+// The known comparers are sorted by their orders, the others by std::sort().
+//
+template <typename SmallSorter, typename Iterator, typename Comparer>
+inline void histogram_sort_by_comparer(Iterator first, Iterator last, Comparer compare,
+                                       std::false_type) {
+    typedef typename std::iterator_traits<Iterator>::value_type      T;
+    typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
+    typedef typename comparer_order<T, Comparer>::type                 order_type;
+
+    histogram_sort<SmallSorter>(first, last, order_type(), iterator_category());
+}
+
+template <typename SmallSorter, typename Iterator, typename Comparer>
+inline void histogram_sort_by_comparer(Iterator first, Iterator last, Comparer compare,
+                                       std::true_type) {
+    if (likely((size_t)(last - first) <= kInsertSortThreshold))
+        SmallSorter::sort(first, last, compare);
+    else
+        std::sort(first, last, compare);
+}
+
+template <typename SmallSorter, typename Iterator, typename Comparer>
+inline void histogram_sort_by_comparer(Iterator first, Iterator last, Comparer compare) {
+    typedef typename std::iterator_traits<Iterator>::value_type T;
+    typedef typename std::is_void<typename comparer_order<T, Comparer>::type>::type is_unknown;
+    histogram_sort_by_comparer<SmallSorter>(first, last, compare, is_unknown());
+}
+
+template <bool Descending, typename Iterator, typename KeyMap>
+inline void histogram_sort_by_key(Iterator first, Iterator last, const KeyMap & key_map) {
+    typedef typename std::iterator_traits<Iterator>::value_type        T;
+    typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
+    typedef KeyOrder<T, KeyMap, Descending>                            order_type;
+    static_assert(std::is_integral<typename order_type::key_type>::value,
+                  "jstd::histogram_sort_by_key(): the key must be a integral type.");
+
+    histogram_sort<InsertSorter>(first, last, order_type(key_map), iterator_category());
+}
+
 } // namespace histogram_detail
 
+//
+// The order of Comparer: std::less<T> and std::greater<T> are sorted by the counting
+// and proxmap sorts, ascending or descending. The other comparers use std::sort().
+//
 template <typename Iterator, typename Comparer>
 void histogram_sort(Iterator first, Iterator last, Comparer compare) {
-    typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
-    histogram_detail::histogram_sort(first, last, compare, iterator_category());
+    histogram_detail::histogram_sort_by_comparer<InsertSorter>(first, last, compare);
 }
 
 template <typename Iterator>
@@ -492,6 +1280,37 @@ void histogram_sort(Iterator first, Iterator last) {
     histogram_sort(first, last, std::less<T>());
 }
 
+//
+// histogram_sort() with the base case of the short arrays set by SmallSorter,
+// jstd::InsertSorter, jstd::SentinelInsertSorter, jstd::PairInsertSorter
+// or jstd::QuadSmallSorter.
+//
+template <typename SmallSorter, typename Iterator, typename Comparer>
+void histogram_sort_tuned(Iterator first, Iterator last, Comparer compare) {
+    histogram_detail::histogram_sort_by_comparer<SmallSorter>(first, last, compare);
+}
+
+template <typename SmallSorter, typename Iterator>
+void histogram_sort_tuned(Iterator first, Iterator last) {
+    typedef typename std::iterator_traits<Iterator>::value_type T;
+    histogram_sort_tuned<SmallSorter>(first, last, std::less<T>());
+}
+
+//
+// Sort the values by the integral keys of key_map(value), a key map must keep the order
+// of the values: the values of the equal keys are in any order. The scores of the records,
+// the fixed point of the prices, etc.
+//
+template <typename Iterator, typename KeyMap>
+void histogram_sort_by_key(Iterator first, Iterator last, KeyMap key_map) {
+    histogram_detail::histogram_sort_by_key<false>(first, last, key_map);
+}
+
+template <typename Iterator, typename KeyMap>
+void histogram_sort_by_key_descending(Iterator first, Iterator last, KeyMap key_map) {
+    histogram_detail::histogram_sort_by_key<true>(first, last, key_map);
+}
+
 } // namespace jstd
 
 #endif // !JSTD_HISTOGRAM_SORT_H
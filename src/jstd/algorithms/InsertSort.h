@@ -78,6 +78,95 @@ inline void insert_sort(ForwardIter first, ForwardIter last,
                   "insert_detail::insert_sort() is not supported std::forward_iterator.");
 }
 
+//
+// Insert each element of [first, last) into the sorted elements before it, the scan
+// of the inner loop has no bound check: an element before first which is not greater
+// than all of [first, last) must stop it (the sentinel).
+//
+template <typename RandomAccessIter, typename Comparer>
+inline void unguarded_insert_sort(RandomAccessIter first, RandomAccessIter last,
+                                  Comparer compare) {
+    typedef RandomAccessIter iterator;
+    typedef typename std::iterator_traits<iterator>::value_type T;
+
+    for (iterator cur = first; cur < last; ++cur) {
+        iterator key = cur;
+        iterator target = std::prev(cur);
+
+        if (compare(*key, *target)) {
+            T tmp = std::move(*key);
+
+            do {
+                *key = std::move(*target);
+                --key;
+            } while (compare(tmp, *--target));
+
+            *key = std::move(tmp);
+        }
+    }
+}
+
+//
+// The pair insertion of Java's DualPivotQuicksort: two elements per outer iteration,
+// the greater one is inserted first, then the smaller one continues the scan from
+// its position, so the sorted elements are scanned once for both. It's unguarded as
+// unguarded_insert_sort(), and stable: the equal elements keep their order.
+//
+template <typename RandomAccessIter, typename Comparer>
+inline void unguarded_pair_insert_sort(RandomAccessIter first, RandomAccessIter last,
+                                       Comparer compare) {
+    typedef RandomAccessIter iterator;
+    typedef typename std::iterator_traits<iterator>::value_type      T;
+    typedef typename std::iterator_traits<iterator>::difference_type diff_type;
+
+    diff_type length = last - first;
+    iterator cur = first;
+    for (diff_type i = 1; i < length; i += 2) {
+        iterator target = std::prev(cur);
+        // The greater one or the later one of the equal ones.
+        T large = std::move(*cur);
+        T small = std::move(*std::next(cur));
+        if (!compare(small, large)) {
+            std::swap(large, small);
+        }
+
+        while (compare(large, *target)) {
+            *std::next(target, 2) = std::move(*target);
+            --target;
+        }
+        *std::next(target, 2) = std::move(large);
+
+        while (compare(small, *target)) {
+            *std::next(target) = std::move(*target);
+            --target;
+        }
+        *std::next(target) = std::move(small);
+
+        cur += 2;
+    }
+
+    if (cur != last) {
+        unguarded_insert_sort(cur, last, compare);
+    }
+}
+
+//
+// Move the (first) minimum to the front, the order of the others is not changed.
+//
+template <typename RandomAccessIter, typename Comparer>
+inline void move_min_to_front(RandomAccessIter first, RandomAccessIter last,
+                              Comparer compare) {
+    typedef RandomAccessIter iterator;
+    typedef typename std::iterator_traits<iterator>::value_type T;
+
+    iterator min_pos = std::min_element(first, last, compare);
+    if (min_pos != first) {
+        T tmp = std::move(*min_pos);
+        std::move_backward(first, min_pos, std::next(min_pos));
+        *first = std::move(tmp);
+    }
+}
+
 } // namespace insert_detail
 
 template <typename Iterator, typename Comparer>
@@ -92,6 +181,94 @@ inline void insert_sort(Iterator first, Iterator last) {
     insert_sort(first, last, std::less<T>());
 }
 
+//
+// The insertion sort with a sentinel: the minimum is moved to the front first,
+// then the inner loop doesn't check the front. Stable.
+//
+template <typename RandomAccessIter, typename Comparer>
+inline void sentinel_insert_sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+    if (likely((last - first) > 1)) {
+        insert_detail::move_min_to_front(first, last, compare);
+        insert_detail::unguarded_insert_sort(std::next(first), last, compare);
+    }
+}
+
+template <typename RandomAccessIter>
+inline void sentinel_insert_sort(RandomAccessIter first, RandomAccessIter last) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type T;
+    sentinel_insert_sort(first, last, std::less<T>());
+}
+
+//
+// The pair insertion sort with a sentinel, see insert_detail::unguarded_pair_insert_sort(). Stable.
+//
+template <typename RandomAccessIter, typename Comparer>
+inline void pair_insert_sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+    if (likely((last - first) > 1)) {
+        insert_detail::move_min_to_front(first, last, compare);
+        insert_detail::unguarded_pair_insert_sort(std::next(first), last, compare);
+    }
+}
+
+template <typename RandomAccessIter>
+inline void pair_insert_sort(RandomAccessIter first, RandomAccessIter last) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type T;
+    pair_insert_sort(first, last, std::less<T>());
+}
+
+//
+// The small sorters, the base cases of histogram_sort_tuned() and sgi::intro_sort_tuned(),
+// see also jstd::QuadSmallSorter.
+//
+//   sort(first, last, compare):            sort [first, last).
+//   unguarded_sort(first, last, compare):  insert each element of [first, last) into the sorted
+//                                          elements before it, an element before first is
+//                                          not greater than all of them.
+//   kSortPartitions:                       sgi::intro_sort_tuned() sorts each short partition
+//                                          by sort(), rather than one final pass at the end.
+//
+struct InsertSorter {
+    static const bool kSortPartitions = false;
+
+    template <typename RandomAccessIter, typename Comparer>
+    static void sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+        jstd::insert_sort(first, last, compare);
+    }
+
+    template <typename RandomAccessIter, typename Comparer>
+    static void unguarded_sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+        insert_detail::unguarded_insert_sort(first, last, compare);
+    }
+};
+
+struct SentinelInsertSorter {
+    static const bool kSortPartitions = false;
+
+    template <typename RandomAccessIter, typename Comparer>
+    static void sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+        jstd::sentinel_insert_sort(first, last, compare);
+    }
+
+    template <typename RandomAccessIter, typename Comparer>
+    static void unguarded_sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+        insert_detail::unguarded_insert_sort(first, last, compare);
+    }
+};
+
+struct PairInsertSorter {
+    static const bool kSortPartitions = false;
+
+    template <typename RandomAccessIter, typename Comparer>
+    static void sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+        jstd::pair_insert_sort(first, last, compare);
+    }
+
+    template <typename RandomAccessIter, typename Comparer>
+    static void unguarded_sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+        insert_detail::unguarded_pair_insert_sort(first, last, compare);
+    }
+};
+
 } // namespace jstd
 
 #endif // !JSTD_INSERT_SORT_H
@@ -0,0 +1,589 @@
+
+#ifndef JSTD_MERGE_K_H
+#define JSTD_MERGE_K_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+#include "jstd/support/LoserTree.h"
+#include "jstd/support/CPUFeatures.h"
+#include "jstd/support/IteratorTraits.h"
+
+#include <assert.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <memory>       // For std::addressof()
+#include <vector>
+#include <functional>   // For std::less<T>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+//
+// The merge of the sorted runs.
+//
+// jstd::merge_2(): the 2-way merge, three kernels:
+//
+//   Branchless merge: the next element is selected by a conditional move and both cursors
+//     are advanced by the result of the compare, there is no branch to mispredict.
+//
+//   Bitonic merge (int32_t and uint32_t with std::less<T>, AVX2 or AVX-512): the two vectors
+//     of the heads are merged by a bitonic network, the low vector is stored and the next
+//     vector is loaded from the run with the smaller head. The kernel is selected by
+//     the CPU features at run time, not by the compile flags (see CPUFeatures.h).
+//
+// jstd::merge_k(): the k-way merge by a loser tree (jstd::LoserTree), the last two runs
+//   are merged by merge_2(). The merge is stable, the ties are taken from the former run.
+//
+//   The small trivial values to a contiguous output are merged pairwise by merge_2() instead,
+//   log2(k) passes between the output and a buffer: up to k = 1024, the passes of the
+//   branchless merge are about 2x faster than the loser tree, and 5-10x faster with
+//   the bitonic merge kernel. The loser tree is for the big records (each value is
+//   copied once) and the other output iterators.
+//
+namespace jstd {
+namespace merge_detail {
+
+// The min length of both runs of the bitonic merge kernel
+static const size_t kSimdMergeThreshold = 64;
+
+// The max size of the values of the pairwise merge
+static const size_t kCascadeMergeMaxValueSize = 16;
+
+template <typename T, typename Compare>
+struct is_less_compare : std::false_type {};
+
+template <typename T>
+struct is_less_compare<T, std::less<T>> : std::true_type {};
+
+template <typename RandomAccessIter1, typename RandomAccessIter2,
+          typename OutputIter, typename Compare>
+OutputIter branchless_merge(RandomAccessIter1 first1, RandomAccessIter1 last1,
+                            RandomAccessIter2 first2, RandomAccessIter2 last2,
+                            OutputIter out, Compare comp) {
+    if (first1 != last1 && first2 != last2) {
+        for (;;) {
+            bool take2 = comp(*first2, *first1);
+            *out = take2 ? *first2 : *first1;
+            ++out;
+            first1 += !take2;
+            first2 += take2;
+            if (first1 == last1 || first2 == last2)
+                break;
+        }
+    }
+    out = std::copy(first1, last1, out);
+    return std::copy(first2, last2, out);
+}
+
+//
+// The end of the bitonic merge: the high vector (tail) and the rest of the runs,
+// one of them is shorter than the vector, which is merged with tail to a buffer first.
+//
+template <typename T, size_t Lanes>
+T * merge_tail(const T (&tail)[Lanes], const T * first1, const T * last1,
+               const T * first2, const T * last2, T * out) {
+    T buffer[Lanes * 2];
+    std::less<T> comp;
+    if (size_t(last1 - first1) < Lanes) {
+        T * buffer_last = branchless_merge(tail, tail + Lanes, first1, last1, buffer, comp);
+        return branchless_merge(buffer, buffer_last, first2, last2, out, comp);
+    } else {
+        T * buffer_last = branchless_merge(tail, tail + Lanes, first2, last2, buffer, comp);
+        return branchless_merge(first1, last1, buffer, buffer_last, out, comp);
+    }
+}
+
+template <typename T>
+T * scalar_merge(const T * first1, const T * last1,
+                 const T * first2, const T * last2, T * out) {
+    return branchless_merge(first1, last1, first2, last2, out, std::less<T>());
+}
+
+#if JSTD_HAS_TARGET_AVX2
+
+struct Avx2Int32MinMax {
+    static JSTD_FORCED_INLINE JSTD_TARGET_AVX2
+    __m256i min(__m256i a, __m256i b) { return _mm256_min_epi32(a, b); }
+    static JSTD_FORCED_INLINE JSTD_TARGET_AVX2
+    __m256i max(__m256i a, __m256i b) { return _mm256_max_epi32(a, b); }
+};
+
+struct Avx2UInt32MinMax {
+    static JSTD_FORCED_INLINE JSTD_TARGET_AVX2
+    __m256i min(__m256i a, __m256i b) { return _mm256_min_epu32(a, b); }
+    static JSTD_FORCED_INLINE JSTD_TARGET_AVX2
+    __m256i max(__m256i a, __m256i b) { return _mm256_max_epu32(a, b); }
+};
+
+//
+// lo and hi are sorted, the 8 smallest are in lo and the rest are in hi, both sorted.
+//
+template <typename MinMax>
+JSTD_FORCED_INLINE JSTD_TARGET_AVX2
+void avx2_bitonic_merge_8x8(__m256i & lo, __m256i & hi) {
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    __m256i r = _mm256_permutevar8x32_epi32(hi, reverse);
+    __m256i l = MinMax::min(lo, r);
+    __m256i h = MinMax::max(lo, r);
+
+    // l and h are bitonic, the distance 4, 2 and 1 stages sort them.
+    __m256i lt = _mm256_permute2x128_si256(l, l, 0x01);
+    __m256i ht = _mm256_permute2x128_si256(h, h, 0x01);
+    l = _mm256_blend_epi32(MinMax::min(l, lt), MinMax::max(l, lt), 0xF0);
+    h = _mm256_blend_epi32(MinMax::min(h, ht), MinMax::max(h, ht), 0xF0);
+
+    lt = _mm256_shuffle_epi32(l, _MM_SHUFFLE(1, 0, 3, 2));
+    ht = _mm256_shuffle_epi32(h, _MM_SHUFFLE(1, 0, 3, 2));
+    l = _mm256_blend_epi32(MinMax::min(l, lt), MinMax::max(l, lt), 0xCC);
+    h = _mm256_blend_epi32(MinMax::min(h, ht), MinMax::max(h, ht), 0xCC);
+
+    lt = _mm256_shuffle_epi32(l, _MM_SHUFFLE(2, 3, 0, 1));
+    ht = _mm256_shuffle_epi32(h, _MM_SHUFFLE(2, 3, 0, 1));
+    lo = _mm256_blend_epi32(MinMax::min(l, lt), MinMax::max(l, lt), 0xAA);
+    hi = _mm256_blend_epi32(MinMax::min(h, ht), MinMax::max(h, ht), 0xAA);
+}
+
+//
+// Both runs have 8 elements at least. The output is not greater than hi and the rest
+// of both runs, the next vector is loaded from the run with the smaller head.
+//
+template <typename MinMax, typename T>
+JSTD_TARGET_AVX2
+T * avx2_bitonic_merge(const T * first1, const T * last1,
+                       const T * first2, const T * last2, T * out) {
+    static const size_t kLanes = 8;
+
+    assert(size_t(last1 - first1) >= kLanes);
+    assert(size_t(last2 - first2) >= kLanes);
+
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first1));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first2));
+    first1 += kLanes;
+    first2 += kLanes;
+    for (;;) {
+        avx2_bitonic_merge_8x8<MinMax>(lo, hi);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), lo);
+        out += kLanes;
+        if (size_t(last1 - first1) < kLanes || size_t(last2 - first2) < kLanes)
+            break;
+        bool take2 = (*first2 < *first1);
+        const T * next = take2 ? first2 : first1;
+        first1 += take2 ? 0 : kLanes;
+        first2 += take2 ? kLanes : 0;
+        lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(next));
+    }
+
+    T tail[kLanes];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(tail), hi);
+    return merge_tail(tail, first1, last1, first2, last2, out);
+}
+
+#endif // JSTD_HAS_TARGET_AVX2
+
+#if JSTD_HAS_TARGET_AVX512
+
+// The _mm512_undefined_epi32() of the gcc intrinsics is reported as uninitialized.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+struct Avx512Int32MinMax {
+    static JSTD_FORCED_INLINE JSTD_TARGET_AVX512
+    __m512i min(__m512i a, __m512i b) { return _mm512_min_epi32(a, b); }
+    static JSTD_FORCED_INLINE JSTD_TARGET_AVX512
+    __m512i max(__m512i a, __m512i b) { return _mm512_max_epi32(a, b); }
+};
+
+struct Avx512UInt32MinMax {
+    static JSTD_FORCED_INLINE JSTD_TARGET_AVX512
+    __m512i min(__m512i a, __m512i b) { return _mm512_min_epu32(a, b); }
+    static JSTD_FORCED_INLINE JSTD_TARGET_AVX512
+    __m512i max(__m512i a, __m512i b) { return _mm512_max_epu32(a, b); }
+};
+
+template <typename MinMax>
+JSTD_FORCED_INLINE JSTD_TARGET_AVX512
+__m512i avx512_min_max(__m512i v, __m512i t, __mmask16 max_lanes) {
+    return _mm512_mask_mov_epi32(MinMax::min(v, t), max_lanes, MinMax::max(v, t));
+}
+
+//
+// lo and hi are sorted, the 16 smallest are in lo and the rest are in hi, both sorted.
+//
+template <typename MinMax>
+JSTD_FORCED_INLINE JSTD_TARGET_AVX512
+void avx512_bitonic_merge_16x16(__m512i & lo, __m512i & hi) {
+    const __m512i reverse = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8,
+                                              7, 6, 5, 4, 3, 2, 1, 0);
+    __m512i r = _mm512_permutexvar_epi32(reverse, hi);
+    __m512i l = MinMax::min(lo, r);
+    __m512i h = MinMax::max(lo, r);
+
+    // l and h are bitonic, the distance 8, 4, 2 and 1 stages sort them.
+    l = avx512_min_max<MinMax>(l, _mm512_shuffle_i32x4(l, l, _MM_SHUFFLE(1, 0, 3, 2)), 0xFF00);
+    h = avx512_min_max<MinMax>(h, _mm512_shuffle_i32x4(h, h, _MM_SHUFFLE(1, 0, 3, 2)), 0xFF00);
+
+    l = avx512_min_max<MinMax>(l, _mm512_shuffle_i32x4(l, l, _MM_SHUFFLE(2, 3, 0, 1)), 0xF0F0);
+    h = avx512_min_max<MinMax>(h, _mm512_shuffle_i32x4(h, h, _MM_SHUFFLE(2, 3, 0, 1)), 0xF0F0);
+
+    l = avx512_min_max<MinMax>(l, _mm512_shuffle_epi32(l, (_MM_PERM_ENUM)_MM_SHUFFLE(1, 0, 3, 2)), 0xCCCC);
+    h = avx512_min_max<MinMax>(h, _mm512_shuffle_epi32(h, (_MM_PERM_ENUM)_MM_SHUFFLE(1, 0, 3, 2)), 0xCCCC);
+
+    lo = avx512_min_max<MinMax>(l, _mm512_shuffle_epi32(l, (_MM_PERM_ENUM)_MM_SHUFFLE(2, 3, 0, 1)), 0xAAAA);
+    hi = avx512_min_max<MinMax>(h, _mm512_shuffle_epi32(h, (_MM_PERM_ENUM)_MM_SHUFFLE(2, 3, 0, 1)), 0xAAAA);
+}
+
+//
+// Both runs have 16 elements at least, as avx2_bitonic_merge().
+//
+template <typename MinMax, typename T>
+JSTD_TARGET_AVX512
+T * avx512_bitonic_merge(const T * first1, const T * last1,
+                         const T * first2, const T * last2, T * out) {
+    static const size_t kLanes = 16;
+
+    assert(size_t(last1 - first1) >= kLanes);
+    assert(size_t(last2 - first2) >= kLanes);
+
+    __m512i lo = _mm512_loadu_si512(reinterpret_cast<const void *>(first1));
+    __m512i hi = _mm512_loadu_si512(reinterpret_cast<const void *>(first2));
+    first1 += kLanes;
+    first2 += kLanes;
+    for (;;) {
+        avx512_bitonic_merge_16x16<MinMax>(lo, hi);
+        _mm512_storeu_si512(reinterpret_cast<void *>(out), lo);
+        out += kLanes;
+        if (size_t(last1 - first1) < kLanes || size_t(last2 - first2) < kLanes)
+            break;
+        bool take2 = (*first2 < *first1);
+        const T * next = take2 ? first2 : first1;
+        first1 += take2 ? 0 : kLanes;
+        first2 += take2 ? kLanes : 0;
+        lo = _mm512_loadu_si512(reinterpret_cast<const void *>(next));
+    }
+
+    T tail[kLanes];
+    _mm512_storeu_si512(reinterpret_cast<void *>(tail), hi);
+    return merge_tail(tail, first1, last1, first2, last2, out);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // JSTD_HAS_TARGET_AVX512
+
+//
+// The bitonic merge of T, resolved once by jstd::CPUFeatures:
+// AVX-512, AVX2, or the branchless merge if the CPU has neither.
+//
+template <typename T>
+struct BitonicMerge {
+    static const bool value = false;
+};
+
+template <typename T, typename Avx2MinMax, typename Avx512MinMax>
+struct BitonicMergeDispatch {
+    static const bool value = true;
+
+    typedef T * (*merge_func)(const T * first1, const T * last1,
+                              const T * first2, const T * last2, T * out);
+
+    struct Path {
+        merge_func   func;
+        const char * name;
+    };
+
+    static const Path & path() {
+        static const Path resolved = resolve();
+        return resolved;
+    }
+
+private:
+    static Path resolve() {
+        const CPUFeatures & cpu = CPUFeatures::get();
+        (void)cpu;
+#if JSTD_HAS_TARGET_AVX512
+        if (cpu.avx512f) {
+            Path avx512 = { &avx512_bitonic_merge<Avx512MinMax, T>, "AVX-512" };
+            return avx512;
+        }
+#endif
+#if JSTD_HAS_TARGET_AVX2
+        if (cpu.avx2) {
+            Path avx2 = { &avx2_bitonic_merge<Avx2MinMax, T>, "AVX2" };
+            return avx2;
+        }
+#endif
+        Path scalar = { &scalar_merge<T>, "scalar" };
+        return scalar;
+    }
+};
+
+#if JSTD_HAS_TARGET_AVX2
+
+#if !JSTD_HAS_TARGET_AVX512
+typedef void Avx512Int32MinMax;
+typedef void Avx512UInt32MinMax;
+#endif
+
+template <>
+struct BitonicMerge<int32_t>
+    : public BitonicMergeDispatch<int32_t, Avx2Int32MinMax, Avx512Int32MinMax> {};
+
+template <>
+struct BitonicMerge<uint32_t>
+    : public BitonicMergeDispatch<uint32_t, Avx2UInt32MinMax, Avx512UInt32MinMax> {};
+
+#endif // JSTD_HAS_TARGET_AVX2
+
+template <typename RandomAccessIter1, typename RandomAccessIter2,
+          typename OutputIter, typename Compare>
+OutputIter merge_2_impl(RandomAccessIter1 first1, RandomAccessIter1 last1,
+                        RandomAccessIter2 first2, RandomAccessIter2 last2,
+                        OutputIter out, Compare comp, std::false_type) {
+    return branchless_merge(first1, last1, first2, last2, out, comp);
+}
+
+template <typename RandomAccessIter1, typename RandomAccessIter2,
+          typename OutputIter, typename Compare>
+OutputIter merge_2_impl(RandomAccessIter1 first1, RandomAccessIter1 last1,
+                        RandomAccessIter2 first2, RandomAccessIter2 last2,
+                        OutputIter out, Compare comp, std::true_type) {
+    typedef typename std::iterator_traits<RandomAccessIter1>::value_type T;
+
+    size_t length1 = static_cast<size_t>(last1 - first1);
+    size_t length2 = static_cast<size_t>(last2 - first2);
+    if (length1 < kSimdMergeThreshold || length2 < kSimdMergeThreshold) {
+        return branchless_merge(first1, last1, first2, last2, out, comp);
+    }
+
+    const T * src1 = std::addressof(*first1);
+    const T * src2 = std::addressof(*first2);
+    T * dest = std::addressof(*out);
+    T * dest_last = BitonicMerge<T>::path().func(src1, src1 + length1, src2, src2 + length2, dest);
+    return out + (dest_last - dest);
+}
+
+template <typename RandomAccessIter1, typename RandomAccessIter2,
+          typename OutputIter, typename Compare>
+struct use_simd_merge {
+    typedef typename std::iterator_traits<RandomAccessIter1>::value_type T;
+
+    static const bool value =
+        BitonicMerge<T>::value &&
+        is_less_compare<T, Compare>::value &&
+        std::is_same<T, typename std::iterator_traits<RandomAccessIter2>::value_type>::value &&
+        is_contiguous_iterator<RandomAccessIter1, T>::value &&
+        is_contiguous_iterator<RandomAccessIter2, T>::value &&
+        is_contiguous_iterator<OutputIter, T>::value;
+};
+
+} // namespace merge_detail
+
+//
+// The kernel of merge_2() of the int32_t and uint32_t runs: "AVX-512", "AVX2" or "scalar".
+//
+inline const char * merge_kernel_name() {
+#if JSTD_HAS_TARGET_AVX2
+    return merge_detail::BitonicMerge<uint32_t>::path().name;
+#else
+    return "scalar";
+#endif
+}
+
+//
+// Merge the sorted runs [first1, last1) and [first2, last2) to out, return the end of out.
+//
+template <typename RandomAccessIter1, typename RandomAccessIter2,
+          typename OutputIter, typename Compare>
+OutputIter merge_2(RandomAccessIter1 first1, RandomAccessIter1 last1,
+                   RandomAccessIter2 first2, RandomAccessIter2 last2,
+                   OutputIter out, Compare comp) {
+    typedef std::integral_constant<bool, merge_detail::use_simd_merge<
+                RandomAccessIter1, RandomAccessIter2, OutputIter, Compare>::value> simd_tag;
+    return merge_detail::merge_2_impl(first1, last1, first2, last2, out, comp, simd_tag());
+}
+
+template <typename RandomAccessIter1, typename RandomAccessIter2, typename OutputIter>
+OutputIter merge_2(RandomAccessIter1 first1, RandomAccessIter1 last1,
+                   RandomAccessIter2 first2, RandomAccessIter2 last2,
+                   OutputIter out) {
+    typedef typename std::iterator_traits<RandomAccessIter1>::value_type T;
+    return jstd::merge_2(first1, last1, first2, last2, out, std::less<T>());
+}
+
+namespace merge_detail {
+
+//
+// The loser tree merge of the non-empty runs (3 at least).
+//
+template <typename Run, typename OutputIter, typename Compare>
+OutputIter loser_tree_merge(std::vector<Run> & cursors, OutputIter out, Compare comp) {
+    typedef typename Run::first_type                                    iterator;
+    typedef typename std::iterator_traits<iterator>::value_type         T;
+
+    size_t sources = cursors.size();
+    assert(sources > 2);
+
+    LoserTree<T, Compare> tree(sources, comp);
+    for (size_t i = 0; i < sources; i++) {
+        tree.set_head(i, *cursors[i].first);
+    }
+    tree.build();
+
+    for (;;) {
+        size_t source = tree.top();
+        Run & cursor = cursors[source];
+        *out = tree.top_value();
+        ++out;
+        ++cursor.first;
+        if (likely(cursor.first != cursor.second)) {
+            tree.replace_top(*cursor.first);
+        } else {
+            tree.pop_top();
+            if (tree.remain() == 2)
+                break;
+        }
+    }
+
+    // The last two runs, in their order.
+    size_t first = 0;
+    while (cursors[first].first == cursors[first].second)
+        first++;
+    size_t second = first + 1;
+    while (cursors[second].first == cursors[second].second)
+        second++;
+    return jstd::merge_2(cursors[first].first, cursors[first].second,
+                         cursors[second].first, cursors[second].second, out, comp);
+}
+
+//
+// The pairwise merge of the non-empty runs (3 at least) by merge_2(),
+// ceil(log2(k)) passes between out and a buffer, the last pass writes out.
+//
+template <typename Run, typename OutputIter, typename Compare>
+OutputIter cascade_merge(std::vector<Run> & cursors, OutputIter out, Compare comp) {
+    typedef typename Run::first_type                                    iterator;
+    typedef typename std::iterator_traits<iterator>::value_type         T;
+
+    size_t sources = cursors.size();
+    assert(sources > 2);
+
+    size_t length = 0;
+    for (size_t i = 0; i < sources; i++) {
+        length += static_cast<size_t>(cursors[i].second - cursors[i].first);
+    }
+    size_t passes = 0;
+    for (size_t runs = sources; runs > 1; runs = (runs + 1) / 2) {
+        passes++;
+    }
+
+    std::unique_ptr<T[]> buffer(new T[length]);
+    T * output = std::addressof(*out);
+    T * dest = (passes & 1) ? output : buffer.get();
+    T * src  = (passes & 1) ? buffer.get() : output;
+
+    // The first pass merges the runs.
+    std::vector<size_t> bounds;
+    bounds.push_back(0);
+    T * dest_last = dest;
+    for (size_t i = 0; i < sources; i += 2) {
+        if (i + 1 < sources) {
+            dest_last = jstd::merge_2(cursors[i].first, cursors[i].second,
+                                      cursors[i + 1].first, cursors[i + 1].second, dest_last, comp);
+        } else {
+            dest_last = std::copy(cursors[i].first, cursors[i].second, dest_last);
+        }
+        bounds.push_back(static_cast<size_t>(dest_last - dest));
+    }
+
+    while (bounds.size() > 2) {
+        std::swap(src, dest);
+        std::vector<size_t> merged_bounds;
+        merged_bounds.push_back(0);
+        for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+            if (i + 2 < bounds.size()) {
+                jstd::merge_2(src + bounds[i], src + bounds[i + 1],
+                              src + bounds[i + 1], src + bounds[i + 2], dest + bounds[i], comp);
+                merged_bounds.push_back(bounds[i + 2]);
+            } else {
+                std::copy(src + bounds[i], src + bounds[i + 1], dest + bounds[i]);
+                merged_bounds.push_back(bounds[i + 1]);
+            }
+        }
+        bounds.swap(merged_bounds);
+    }
+
+    assert(dest == output);
+    return out + length;
+}
+
+template <typename Run, typename OutputIter, typename Compare>
+OutputIter merge_k_impl(std::vector<Run> & cursors, OutputIter out, Compare comp, std::false_type) {
+    return loser_tree_merge(cursors, out, comp);
+}
+
+template <typename Run, typename OutputIter, typename Compare>
+OutputIter merge_k_impl(std::vector<Run> & cursors, OutputIter out, Compare comp, std::true_type) {
+    return cascade_merge(cursors, out, comp);
+}
+
+template <typename T, typename OutputIter>
+struct use_cascade_merge {
+    static const bool value =
+        std::is_trivial<T>::value &&
+        (sizeof(T) <= kCascadeMergeMaxValueSize) &&
+        is_contiguous_iterator<OutputIter, T>::value;
+};
+
+} // namespace merge_detail
+
+//
+// Merge the sorted runs to out, runs is a container of the std::pair<first, last>
+// of each run, return the end of out.
+//
+template <typename Runs, typename OutputIter, typename Compare>
+OutputIter merge_k(const Runs & runs, OutputIter out, Compare comp) {
+    typedef typename Runs::value_type                                   run_type;
+    typedef typename run_type::first_type                               iterator;
+    typedef typename std::iterator_traits<iterator>::value_type         T;
+
+    std::vector<run_type> cursors;
+    cursors.reserve(runs.size());
+    for (auto it = runs.begin(); it != runs.end(); ++it) {
+        if (it->first != it->second)
+            cursors.push_back(*it);
+    }
+
+    size_t sources = cursors.size();
+    if (sources == 0)
+        return out;
+    else if (sources == 1)
+        return std::copy(cursors[0].first, cursors[0].second, out);
+    else if (sources == 2)
+        return jstd::merge_2(cursors[0].first, cursors[0].second,
+                             cursors[1].first, cursors[1].second, out, comp);
+
+    typedef std::integral_constant<bool,
+                merge_detail::use_cascade_merge<T, OutputIter>::value> cascade_tag;
+    return merge_detail::merge_k_impl(cursors, out, comp, cascade_tag());
+}
+
+template <typename Runs, typename OutputIter>
+OutputIter merge_k(const Runs & runs, OutputIter out) {
+    typedef typename Runs::value_type::first_type                       iterator;
+    typedef typename std::iterator_traits<iterator>::value_type         T;
+    return jstd::merge_k(runs, out, std::less<T>());
+}
+
+} // namespace jstd
+
+#endif // !JSTD_MERGE_K_H
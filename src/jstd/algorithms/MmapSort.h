@@ -0,0 +1,250 @@
+
+#ifndef JSTD_MMAP_SORT_H
+#define JSTD_MMAP_SORT_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#ifdef _MSC_VER
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#endif
+
+#include "jstd/basic/stddef.h"
+#include "jstd/support/MappedFile.h"
+#include "jstd/algorithms/ska_sort.hpp"
+#include "jstd/algorithms/HistogramSort.h"
+
+#include <assert.h>
+#include <stdio.h>      // For fopen(), fclose()
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>      // For std::memcpy()
+#include <string>
+#include <type_traits>
+#include <utility>
+
+//
+// Zero-copy sort of a binary file of fixed size records (the file is an array of T),
+// which fits in the memory: the file is memory mapped and sorted in the page cache,
+// without the read() and write() copies of a std::vector.
+//
+// jstd::mmap_sort(path): in place, the file is mapped shared, sorted by ska_sort()
+// and flushed by msync().
+//
+// jstd::mmap_sort(input_path, output_path): the input is mapped read only and copied
+// to the mapping of the output file, which is sorted in place. The input isn't changed
+// and no page of it is duplicated: the memory is the page cache of the two files.
+//
+// jstd::mmap_histogram_sort() and jstd::mmap_histogram_sort_by_key() are the same
+// modes with histogram_sort(), for the integral records or the integral keys.
+// histogram_sort() allocates a buffer of the records, unlike the in-place ska_sort().
+//
+// The madvise() hints of each phase: the file is read ahead and faulted in sequentially
+// (sequential, willneed), the passes of the sort then access the pages randomly (random),
+// the flush is sequential again (sequential).
+//
+namespace jstd {
+namespace mmap_detail {
+
+// The stride of prefault(), a page
+static const size_t kPrefaultStride = 4096;
+
+//
+// Read a byte of every page, in order, the read ahead of the sequential hint
+// loads the file before the random accesses of the sort.
+//
+inline void prefault(const MappedFile & file) {
+    const volatile unsigned char * bytes = static_cast<const unsigned char *>(file.data());
+    unsigned char sum = 0;
+    for (size_t offset = 0; offset < file.size(); offset += kPrefaultStride) {
+        sum ^= bytes[offset];
+    }
+    (void)sum;
+}
+
+inline void advise_load(MappedFile & file) {
+    file.advise(MappedFile::Sequential);
+    file.advise(MappedFile::WillNeed);
+}
+
+inline bool create_empty_file(const std::string & path) {
+    FILE * file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+    return (fclose(file) == 0);
+}
+
+//
+// Return false if the file doesn't exist or isn't an array of T.
+//
+template <typename T>
+bool get_record_count(const std::string & path, size_t & count) {
+    uint64_t size;
+    if (!MappedFile::get_file_size(path, size))
+        return false;
+    if ((size % sizeof(T)) != 0 || size > uint64_t(SIZE_MAX))
+        return false;
+    count = static_cast<size_t>(size / sizeof(T));
+    return true;
+}
+
+//
+// Sort the mapping, which is resident, by sorter(first, last) and write it back.
+//
+template <typename T, typename Sorter>
+bool sort_and_flush(MappedFile & file, size_t count, Sorter & sorter) {
+    // The passes of the sort scatter over the whole file, no read ahead.
+    file.advise(MappedFile::Random);
+    T * data = static_cast<T *>(file.data());
+    sorter(data, data + count);
+
+    // Write back the sorted pages.
+    file.advise(MappedFile::Sequential);
+    bool success = file.flush();
+    return (file.close() && success);
+}
+
+template <typename T, typename Sorter>
+bool sort_in_place(const std::string & path, Sorter sorter) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "jstd::mmap_sort() only supports the trivially copyable records.");
+    size_t count;
+    if (!get_record_count<T>(path, count))
+        return false;
+    if (count == 0)
+        return true;
+
+    MappedFile file;
+    if (!file.open(path, MappedFile::ReadWrite))
+        return false;
+    advise_load(file);
+    prefault(file);
+    return sort_and_flush<T>(file, count, sorter);
+}
+
+template <typename T, typename Sorter>
+bool sort_to_output(const std::string & input_path, const std::string & output_path,
+                    Sorter sorter) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "jstd::mmap_sort() only supports the trivially copyable records.");
+    size_t count;
+    if (!get_record_count<T>(input_path, count))
+        return false;
+    if (count == 0)
+        return create_empty_file(output_path);
+
+    MappedFile input, output;
+    if (!input.open(input_path, MappedFile::ReadOnly))
+        return false;
+    if (!output.create(output_path, count * sizeof(T)))
+        return false;
+
+    // The copy reads the input and faults in the output in order.
+    advise_load(input);
+    output.advise(MappedFile::Sequential);
+    std::memcpy(output.data(), input.data(), count * sizeof(T));
+    input.close();
+
+    return sort_and_flush<T>(output, count, sorter);
+}
+
+template <typename ExtractKey>
+struct SkaSorter {
+    ExtractKey & extract_key;
+
+    template <typename T>
+    void operator () (T * first, T * last) {
+        ska_sort(first, last, extract_key);
+    }
+};
+
+struct HistogramSorter {
+    template <typename T>
+    void operator () (T * first, T * last) {
+        jstd::histogram_sort(first, last);
+    }
+};
+
+template <typename KeyMap>
+struct HistogramKeySorter {
+    const KeyMap & key_map;
+
+    template <typename T>
+    void operator () (T * first, T * last) {
+        jstd::histogram_sort_by_key(first, last, key_map);
+    }
+};
+
+} // namespace mmap_detail
+
+//
+// Sort the file in place by extract_key(record),
+// mmap_sort<T>(input_path, output_path) is not this one.
+//
+template <typename T, typename ExtractKey>
+typename std::enable_if<!std::is_convertible<ExtractKey, std::string>::value, bool>::type
+mmap_sort(const std::string & path, ExtractKey && extract_key) {
+    mmap_detail::SkaSorter<ExtractKey> sorter = { extract_key };
+    return mmap_detail::sort_in_place<T>(path, sorter);
+}
+
+template <typename T>
+bool mmap_sort(const std::string & path) {
+    return jstd::mmap_sort<T>(path, ska_detail::IdentityFunctor());
+}
+
+//
+// Sort the input file by extract_key(record) into the output file.
+//
+template <typename T, typename ExtractKey>
+bool mmap_sort(const std::string & input_path, const std::string & output_path,
+               ExtractKey && extract_key) {
+    mmap_detail::SkaSorter<ExtractKey> sorter = { extract_key };
+    return mmap_detail::sort_to_output<T>(input_path, output_path, sorter);
+}
+
+template <typename T>
+bool mmap_sort(const std::string & input_path, const std::string & output_path) {
+    return jstd::mmap_sort<T>(input_path, output_path, ska_detail::IdentityFunctor());
+}
+
+//
+// Sort the file of the integral records by histogram_sort(), in place or into the output file.
+//
+template <typename T>
+bool mmap_histogram_sort(const std::string & path) {
+    static_assert(std::is_integral<T>::value,
+                  "jstd::mmap_histogram_sort() only supports the integral records.");
+    return mmap_detail::sort_in_place<T>(path, mmap_detail::HistogramSorter());
+}
+
+template <typename T>
+bool mmap_histogram_sort(const std::string & input_path, const std::string & output_path) {
+    static_assert(std::is_integral<T>::value,
+                  "jstd::mmap_histogram_sort() only supports the integral records.");
+    return mmap_detail::sort_to_output<T>(input_path, output_path, mmap_detail::HistogramSorter());
+}
+
+//
+// Sort the file by the integral keys of key_map(record), see histogram_sort_by_key().
+//
+template <typename T, typename KeyMap>
+bool mmap_histogram_sort_by_key(const std::string & path, KeyMap key_map) {
+    mmap_detail::HistogramKeySorter<KeyMap> sorter = { key_map };
+    return mmap_detail::sort_in_place<T>(path, sorter);
+}
+
+template <typename T, typename KeyMap>
+bool mmap_histogram_sort_by_key(const std::string & input_path, const std::string & output_path,
+                                KeyMap key_map) {
+    mmap_detail::HistogramKeySorter<KeyMap> sorter = { key_map };
+    return mmap_detail::sort_to_output<T>(input_path, output_path, sorter);
+}
+
+} // namespace jstd
+
+#endif // !JSTD_MMAP_SORT_H
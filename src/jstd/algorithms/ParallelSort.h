@@ -0,0 +1,313 @@
+
+#ifndef JSTD_PARALLEL_SORT_H
+#define JSTD_PARALLEL_SORT_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+#include "jstd/support/TaskPool.h"
+#include "jstd/support/IteratorTraits.h"
+#include "jstd/algorithms/orlp-pdqsort.h"
+
+#include <assert.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <memory>       // For std::unique_ptr<T>, std::allocator<T>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+//
+// Parallel sorts on jstd::TaskPool.
+//
+// jstd::parallel_sort(): the pdqsort loop, the left partition of each split larger
+// than the sequential cutoff becomes a task, the right partition is looped on.
+// Partitions not larger than the cutoff are finished by the sequential pdqsort loop.
+//
+// jstd::parallel_stable_sort(): merge sort, both halves are sorted in parallel,
+// ping-ponging between the array and a buffer, then merged by a parallel merge
+// which splits the bigger run at its middle and the other run by binary search.
+//
+namespace jstd {
+namespace parallel_detail {
+
+// The smallest sequential cutoff of the parallel split
+static const size_t kMinSequentialCutoff = 8192;
+
+// The max number of tasks per thread, for the load balance
+static const size_t kTasksPerThread = 8;
+
+// The sequential cutoff of the parallel merge
+static const size_t kMergeCutoff = 16384;
+
+inline size_t sequential_cutoff(size_t length, const TaskPool & pool) {
+    size_t cutoff = length / (pool.thread_count() * kTasksPerThread);
+    return (cutoff > kMinSequentialCutoff) ? cutoff : kMinSequentialCutoff;
+}
+
+template <typename Iter, typename Compare, bool Branchless>
+void parallel_pdqsort_loop(Iter begin, Iter end, Compare comp, int bad_allowed, bool leftmost,
+                           size_t cutoff, TaskPool & pool, TaskGroup & group) {
+    typedef typename std::iterator_traits<Iter>::difference_type diff_t;
+    using namespace orlp::pdqsort_detail;
+
+    while (true) {
+        diff_t size = end - begin;
+
+        if (size_t(size) <= cutoff) {
+            pdqsort_loop<Iter, Compare, Branchless>(begin, end, comp, bad_allowed, leftmost);
+            return;
+        }
+
+        // Choose pivot as pseudomedian of 9.
+        diff_t s2 = size / 2;
+        sort3(begin, begin + s2, end - 1, comp);
+        sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+        sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+        sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+        std::iter_swap(begin, begin + s2);
+
+        // All the elements equal to *(begin - 1) go to the left partition, it's sorted.
+        if (!leftmost && !comp(*(begin - 1), *begin)) {
+            begin = partition_left(begin, end, comp) + 1;
+            continue;
+        }
+
+        std::pair<Iter, bool> part_result =
+            Branchless ? partition_right_branchless(begin, end, comp)
+                       : partition_right(begin, end, comp);
+        Iter pivot_pos = part_result.first;
+        bool already_partitioned = part_result.second;
+
+        diff_t l_size = pivot_pos - begin;
+        diff_t r_size = end - (pivot_pos + 1);
+        bool highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+
+        if (highly_unbalanced) {
+            // Too many bad partitions, switch to the sequential loop, it ends up with heapsort.
+            if (--bad_allowed == 0) {
+                std::make_heap(begin, end, comp);
+                std::sort_heap(begin, end, comp);
+                return;
+            }
+
+            if (l_size >= kInsertionSortThreshold) {
+                std::iter_swap(begin,             begin + l_size / 4);
+                std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+                if (l_size > kNintherThreshold) {
+                    std::iter_swap(begin + 1,         begin + (l_size / 4 + 1));
+                    std::iter_swap(begin + 2,         begin + (l_size / 4 + 2));
+                    std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+                    std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+                }
+            }
+
+            if (r_size >= kInsertionSortThreshold) {
+                std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+                std::iter_swap(end - 1,                   end - r_size / 4);
+                if (r_size > kNintherThreshold) {
+                    std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+                    std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+                    std::iter_swap(end - 2,             end - (1 + r_size / 4));
+                    std::iter_swap(end - 3,             end - (2 + r_size / 4));
+                }
+            }
+        } else {
+            if (already_partitioned && partial_insertion_sort(begin, pivot_pos, comp)
+                                    && partial_insertion_sort(pivot_pos + 1, end, comp)) return;
+        }
+
+        // The left partition becomes a task, loop on the right partition.
+        if (size_t(l_size) > cutoff) {
+            Iter left_end = pivot_pos;
+            pool.submit(group, [begin, left_end, comp, bad_allowed, leftmost, cutoff, &pool, &group]() {
+                parallel_pdqsort_loop<Iter, Compare, Branchless>(begin, left_end, comp, bad_allowed,
+                                                                 leftmost, cutoff, pool, group);
+            });
+        } else {
+            pdqsort_loop<Iter, Compare, Branchless>(begin, pivot_pos, comp, bad_allowed, leftmost);
+        }
+        begin = pivot_pos + 1;
+        leftmost = false;
+    }
+}
+
+//
+// Merge the sorted runs [first1, last1) and [first2, last2) into dest, stable.
+//
+template <typename T, typename Compare>
+void parallel_merge(T * first1, T * last1, T * first2, T * last2, T * dest,
+                    Compare comp, TaskPool & pool) {
+    size_t size1 = static_cast<size_t>(last1 - first1);
+    size_t size2 = static_cast<size_t>(last2 - first2);
+    if ((size1 + size2) <= kMergeCutoff || pool.thread_count() <= 1) {
+        std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1),
+                   std::make_move_iterator(first2), std::make_move_iterator(last2),
+                   dest, comp);
+        return;
+    }
+
+    T * mid1;
+    T * mid2;
+    if (size1 >= size2) {
+        mid1 = first1 + size1 / 2;
+        mid2 = std::lower_bound(first2, last2, *mid1, comp);
+    } else {
+        mid2 = first2 + size2 / 2;
+        mid1 = std::upper_bound(first1, last1, *mid2, comp);
+    }
+    T * dest_mid = dest + (mid1 - first1) + (mid2 - first2);
+
+    TaskGroup group;
+    pool.submit(group, [first1, mid1, first2, mid2, dest, comp, &pool]() {
+        parallel_merge(first1, mid1, first2, mid2, dest, comp, pool);
+    });
+    parallel_merge(mid1, last1, mid2, last2, dest_mid, comp, pool);
+    pool.wait(group);
+}
+
+//
+// The buffer of parallel_stable_sort(): the raw storage of length values, move-constructed
+// from the array, so value_type doesn't need a default constructor. The sort starts in
+// the buffer and its result is merged back into the array.
+//
+template <typename T>
+class MergeBuffer {
+private:
+    struct Deallocator {
+        size_t length;
+
+        void operator () (T * ptr) const {
+            std::allocator<T>().deallocate(ptr, length);
+        }
+    };
+
+    std::unique_ptr<T, Deallocator> storage_;
+    size_t length_;
+
+public:
+    MergeBuffer(T * src, size_t length)
+        : storage_(std::allocator<T>().allocate(length), Deallocator{length}), length_(length) {
+        std::uninitialized_copy(std::make_move_iterator(src),
+                                std::make_move_iterator(src + length), storage_.get());
+    }
+
+    ~MergeBuffer() {
+        T * values = storage_.get();
+        for (size_t i = 0; i < length_; i++) {
+            values[i].~T();
+        }
+    }
+
+    T * data() const { return storage_.get(); }
+};
+
+//
+// Sort [first, first + length), the result is in buffer if into_buffer is true.
+//
+template <typename T, typename Compare>
+void parallel_merge_sort(T * first, T * buffer, size_t length, bool into_buffer,
+                         size_t cutoff, Compare comp, TaskPool & pool) {
+    if (length <= cutoff) {
+        std::stable_sort(first, first + length, comp);
+        if (into_buffer)
+            std::move(first, first + length, buffer);
+        return;
+    }
+
+    size_t half = length / 2;
+    TaskGroup group;
+    pool.submit(group, [first, buffer, half, into_buffer, cutoff, comp, &pool]() {
+        parallel_merge_sort(first, buffer, half, !into_buffer, cutoff, comp, pool);
+    });
+    parallel_merge_sort(first + half, buffer + half, length - half, !into_buffer, cutoff, comp, pool);
+    pool.wait(group);
+
+    if (into_buffer)
+        parallel_merge(first, first + half, first + half, first + length, buffer, comp, pool);
+    else
+        parallel_merge(buffer, buffer + half, buffer + half, buffer + length, first, comp, pool);
+}
+
+} // namespace parallel_detail
+
+template <typename Iter, typename Compare>
+void parallel_sort(Iter first, Iter last, Compare comp, TaskPool & pool) {
+    typedef typename std::iterator_traits<Iter>::value_type value_type;
+    typedef typename std::iterator_traits<Iter>::iterator_category iterator_category;
+    static_assert(std::is_same<iterator_category, std::random_access_iterator_tag>::value,
+                  "jstd::parallel_sort() only supports random access iterators.");
+    static const bool kBranchless =
+        orlp::pdqsort_detail::is_default_compare<typename std::decay<Compare>::type>::value &&
+        std::is_arithmetic<value_type>::value;
+
+    size_t length = static_cast<size_t>(last - first);
+    if (unlikely(length <= 1))
+        return;
+
+    int bad_allowed = orlp::pdqsort_detail::log2(last - first);
+    if (pool.thread_count() <= 1 || length <= parallel_detail::kMinSequentialCutoff) {
+        orlp::pdqsort_detail::pdqsort_loop<Iter, Compare, kBranchless>(first, last, comp, bad_allowed);
+        return;
+    }
+
+    size_t cutoff = parallel_detail::sequential_cutoff(length, pool);
+    TaskGroup group;
+    parallel_detail::parallel_pdqsort_loop<Iter, Compare, kBranchless>(
+        first, last, comp, bad_allowed, true, cutoff, pool, group);
+    pool.wait(group);
+}
+
+template <typename Iter>
+void parallel_sort(Iter first, Iter last, TaskPool & pool) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    parallel_sort(first, last, std::less<T>(), pool);
+}
+
+template <typename Iter>
+void parallel_sort(Iter first, Iter last) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    parallel_sort(first, last, std::less<T>(), jstd::default_task_pool());
+}
+
+template <typename Iter, typename Compare>
+void parallel_stable_sort(Iter first, Iter last, Compare comp, TaskPool & pool) {
+    typedef typename std::iterator_traits<Iter>::value_type value_type;
+    typedef typename std::iterator_traits<Iter>::iterator_category iterator_category;
+    static_assert(std::is_same<iterator_category, std::random_access_iterator_tag>::value,
+                  "jstd::parallel_stable_sort() only supports random access iterators.");
+    static_assert(is_contiguous_iterator<Iter, value_type>::value,
+                  "jstd::parallel_stable_sort() only supports contiguous iterators "
+                  "(pointers, std::vector<T>::iterator), the merges work on T *.");
+
+    size_t length = static_cast<size_t>(last - first);
+    if (pool.thread_count() <= 1 || length <= parallel_detail::kMinSequentialCutoff) {
+        std::stable_sort(first, last, comp);
+        return;
+    }
+
+    size_t cutoff = parallel_detail::sequential_cutoff(length, pool);
+    value_type * data = &*first;
+    parallel_detail::MergeBuffer<value_type> buffer(data, length);
+    parallel_detail::parallel_merge_sort(buffer.data(), data, length, true, cutoff, comp, pool);
+}
+
+template <typename Iter>
+void parallel_stable_sort(Iter first, Iter last, TaskPool & pool) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    parallel_stable_sort(first, last, std::less<T>(), pool);
+}
+
+template <typename Iter>
+void parallel_stable_sort(Iter first, Iter last) {
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    parallel_stable_sort(first, last, std::less<T>(), jstd::default_task_pool());
+}
+
+} // namespace jstd
+
+#endif // !JSTD_PARALLEL_SORT_H
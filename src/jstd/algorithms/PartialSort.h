@@ -0,0 +1,414 @@
+
+#ifndef JSTD_PARTIAL_SORT_H
+#define JSTD_PARTIAL_SORT_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+#include "jstd/algorithms/InsertSort.h"
+#include "jstd/algorithms/HistogramSort.h"
+#include "jstd/algorithms/orlp-pdqsort.h"
+
+#include <assert.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>        // For std::log(), std::exp(), std::sqrt()
+#include <iterator>
+#include <limits>
+#include <memory>       // For std::unique_ptr<T>
+#include <vector>
+#include <functional>   // For std::less<T>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+//
+// Top-K: partial sort, selection and top_k().
+//
+// Three engines, chosen by k and the value type:
+//
+//   Heap select (k <= kHeapSelectMaxK): a max-heap of the k smallest elements,
+//     the rest are compared with the top of the heap. For the arithmetic types the
+//     elements are filtered a block at a time by a branchless compare with the top,
+//     which the compiler vectorizes, almost all the blocks have no candidate.
+//
+//   Floyd-Rivest select: quickselect whose pivots are selected from a small sample,
+//     so the k-th element is in a small range after one or two partitions.
+//
+//   Histogram select (top_k() of integers with std::less<T>): one counting pass over
+//     the buckets of histogram_detail::calc_bucket_count(), then only the values of the
+//     buckets up to the bucket of the k-th value are copied and sorted, rather than
+//     the whole range. (In place, a 3-way partition by bucket is slower than
+//     Floyd-Rivest select, so nth_element() and partial_sort() don't use it.)
+//
+namespace jstd {
+
+template <typename RandomAccessIter, typename Compare>
+void partial_sort(RandomAccessIter first, RandomAccessIter middle, RandomAccessIter last, Compare comp);
+
+namespace partial_detail {
+
+// The max k of the heap select
+static const size_t kHeapSelectMaxK = 256;
+
+// The block size of the heap select filter
+static const size_t kFilterBlockSize = 16;
+
+// The threshold of built-in insertion sort
+static const size_t kInsertSortThreshold = 32;
+
+// The min range of the Floyd-Rivest sampling
+static const ptrdiff_t kFloydRivestThreshold = 600;
+
+// The min length of the histogram select of top_k()
+static const size_t kHistogramSelectThreshold = 65536;
+
+// The number of the buckets of the histogram select
+static const size_t kHistogramSelectBuckets = 4096;
+
+template <typename T, typename Compare>
+struct is_less_compare : std::false_type {};
+
+template <typename T>
+struct is_less_compare<T, std::less<T>> : std::true_type {};
+
+//
+// Replace the top of the max-heap [first, first + size) with value.
+//
+template <typename RandomAccessIter, typename T, typename Compare>
+void replace_heap_top(RandomAccessIter first, ptrdiff_t size, T && value, Compare & comp) {
+    ptrdiff_t hole = 0;
+    ptrdiff_t child = 1;
+    while (child < size) {
+        if ((child + 1) < size && comp(first[child], first[child + 1]))
+            child++;
+        if (!comp(value, first[child]))
+            break;
+        first[hole] = std::move(first[child]);
+        hole = child;
+        child = hole * 2 + 1;
+    }
+    first[hole] = std::forward<T>(value);
+}
+
+//
+// Replace the top of the heap with *iter, in place the old top is moved to *iter,
+// so [first, last) keeps all its elements.
+//
+template <typename RandomAccessIter, typename Iter, typename Compare>
+inline void replace_heap_top_with(RandomAccessIter heap, ptrdiff_t k, Iter iter, Compare & comp,
+                                  std::true_type /* in_place */) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type value_type;
+    value_type value = std::move(*iter);
+    *iter = std::move(*heap);
+    replace_heap_top(heap, k, std::move(value), comp);
+}
+
+template <typename RandomAccessIter, typename Iter, typename Compare>
+inline void replace_heap_top_with(RandomAccessIter heap, ptrdiff_t k, Iter iter, Compare & comp,
+                                  std::false_type /* in_place */) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type value_type;
+    replace_heap_top(heap, k, value_type(*iter), comp);
+}
+
+//
+// Keep the k smallest elements of the max-heap [heap, heap + k) and [first, last).
+//
+template <typename RandomAccessIter, typename Iter, typename Compare, typename InPlace>
+void heap_select_scan(RandomAccessIter heap, ptrdiff_t k, Iter first, Iter last,
+                      Compare & comp, InPlace in_place, std::false_type /* filter */) {
+    for (; first != last; ++first) {
+        if (comp(*first, *heap)) {
+            replace_heap_top_with(heap, k, first, comp, in_place);
+        }
+    }
+}
+
+template <typename RandomAccessIter, typename Iter, typename Compare, typename InPlace>
+void heap_select_scan(RandomAccessIter heap, ptrdiff_t k, Iter first, Iter last,
+                      Compare & comp, InPlace in_place, std::true_type /* filter */) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type value_type;
+
+    value_type top = *heap;
+    ptrdiff_t length = last - first;
+    ptrdiff_t blocks_end = length - (length % ptrdiff_t(kFilterBlockSize));
+    for (ptrdiff_t i = 0; i < blocks_end; i += ptrdiff_t(kFilterBlockSize)) {
+        // Branchless, the whole block is tested at once.
+        bool any_less = false;
+        for (size_t j = 0; j < kFilterBlockSize; j++) {
+            any_less |= comp(first[i + j], top);
+        }
+        if (likely(!any_less))
+            continue;
+        heap_select_scan(heap, k, first + i, first + i + ptrdiff_t(kFilterBlockSize),
+                         comp, in_place, std::false_type());
+        top = *heap;
+    }
+    heap_select_scan(heap, k, first + blocks_end, last, comp, in_place, std::false_type());
+}
+
+template <typename T, typename Compare>
+struct UseSelectFilter
+    : std::integral_constant<bool, std::is_arithmetic<T>::value &&
+                                   orlp::pdqsort_detail::is_default_compare<Compare>::value> {};
+
+//
+// [first, middle) is the sorted k smallest elements of [first, last).
+//
+template <typename RandomAccessIter, typename Compare>
+void heap_partial_sort(RandomAccessIter first, RandomAccessIter middle, RandomAccessIter last,
+                       Compare & comp) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type value_type;
+    typedef typename std::decay<Compare>::type compare_type;
+
+    std::make_heap(first, middle, comp);
+    heap_select_scan(first, middle - first, middle, last, comp, std::true_type(),
+                     UseSelectFilter<value_type, compare_type>());
+    std::sort_heap(first, middle, comp);
+}
+
+//
+// Select the k-th element of [first + left, first + right] into first + k.
+//
+// See: https://en.wikipedia.org/wiki/Floyd%E2%80%93Rivest_algorithm
+//
+template <typename RandomAccessIter, typename Compare>
+void floyd_rivest_select(RandomAccessIter first, ptrdiff_t left, ptrdiff_t right, ptrdiff_t k,
+                         Compare & comp, int bad_allowed) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type value_type;
+
+    while (right > left) {
+        if ((right - left) < ptrdiff_t(kInsertSortThreshold)) {
+            jstd::insert_sort(first + left, first + right + 1, comp);
+            return;
+        }
+        // Too many bad partitions, the heap select has no worst case.
+        if (--bad_allowed < 0) {
+            std::partial_sort(first + left, first + k + 1, first + right + 1, comp);
+            return;
+        }
+
+        if ((right - left) > kFloydRivestThreshold) {
+            // Select the pivot from a sample, which is a little below and above the k-th.
+            double n  = static_cast<double>(right - left + 1);
+            double i  = static_cast<double>(k - left + 1);
+            double z  = std::log(n);
+            double s  = 0.5 * std::exp(2.0 * z / 3.0);
+            double sd = 0.5 * std::sqrt(z * s * (n - s) / n) * ((i < n / 2) ? -1.0 : 1.0);
+            ptrdiff_t new_left  = static_cast<ptrdiff_t>(static_cast<double>(k) - i * s / n + sd);
+            ptrdiff_t new_right = static_cast<ptrdiff_t>(static_cast<double>(k) + (n - i) * s / n + sd);
+            new_left  = (new_left  > left)  ? new_left  : left;
+            new_right = (new_right < right) ? new_right : right;
+            floyd_rivest_select(first, new_left, new_right, k, comp, bad_allowed);
+        }
+
+        value_type pivot = first[k];
+        ptrdiff_t i = left;
+        ptrdiff_t j = right;
+        std::iter_swap(first + left, first + k);
+        if (comp(pivot, first[right]))
+            std::iter_swap(first + right, first + left);
+        while (i < j) {
+            std::iter_swap(first + i, first + j);
+            i++;
+            j--;
+            while (comp(first[i], pivot))
+                i++;
+            while (comp(pivot, first[j]))
+                j--;
+        }
+        if (!comp(first[left], pivot) && !comp(pivot, first[left])) {
+            std::iter_swap(first + left, first + j);
+        } else {
+            j++;
+            std::iter_swap(first + j, first + right);
+        }
+        if (j <= k)
+            left = j + 1;
+        if (k <= j)
+            right = j - 1;
+    }
+}
+
+template <typename RandomAccessIter, typename Compare>
+void floyd_rivest_select(RandomAccessIter first, RandomAccessIter nth, RandomAccessIter last,
+                         Compare & comp) {
+    ptrdiff_t length = last - first;
+    int bad_allowed = orlp::pdqsort_detail::log2(length) * 2;
+    floyd_rivest_select(first, 0, length - 1, nth - first, comp, bad_allowed);
+}
+
+//
+// Copy the candidates of the k smallest integers of [first, last) to selected:
+// the buckets of the values are (value - minVal) >> shift, all the values of the buckets
+// below the bucket of the k-th value and of this bucket are copied, at least k values.
+// Return false if the range of the values is too large.
+//
+template <typename RandomAccessIter>
+bool histogram_select_copy(RandomAccessIter first, RandomAccessIter last, size_t k,
+                           std::vector<typename std::iterator_traits<RandomAccessIter>::value_type> & selected) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type value_type;
+    typedef typename std::make_unsigned<value_type>::type               unsigned_type;
+
+    value_type minVal = *first;
+    value_type maxVal = *first;
+    for (RandomAccessIter iter = std::next(first); iter != last; ++iter) {
+        minVal = (*iter < minVal) ? *iter : minVal;
+        maxVal = (*iter > maxVal) ? *iter : maxVal;
+    }
+
+    unsigned_type distance = static_cast<unsigned_type>(static_cast<unsigned_type>(maxVal) -
+                                                        static_cast<unsigned_type>(minVal));
+    if (distance == 0) {
+        selected.assign(first, first + k);
+        return true;
+    }
+    if (uint64_t(distance) >= uint64_t(std::numeric_limits<ptrdiff_t>::max()))
+        return false;
+
+    // Few buckets, the counters stay in the L1 cache.
+    std::pair<size_t, size_t> bucketInfo =
+        histogram_detail::calc_bucket_count(ptrdiff_t(kHistogramSelectBuckets),
+                                            static_cast<ptrdiff_t>(distance),
+                                            histogram_detail::kMaxBucketCount);
+    size_t bucketCount = bucketInfo.first;
+    size_t shift = bucketInfo.second;
+
+    std::unique_ptr<uint32_t[]> counts(new uint32_t[bucketCount]());
+    for (RandomAccessIter iter = first; iter != last; ++iter) {
+        size_t bucket = size_t(static_cast<unsigned_type>(static_cast<unsigned_type>(*iter) -
+                                                          static_cast<unsigned_type>(minVal))) >> shift;
+        counts[bucket]++;
+    }
+
+    // Find the bucket of the k-th value.
+    size_t target = 0;
+    size_t below = 0;
+    while ((below + counts[target]) < k) {
+        below += counts[target];
+        target++;
+    }
+
+    selected.reserve(below + counts[target]);
+    for (RandomAccessIter iter = first; iter != last; ++iter) {
+        size_t bucket = size_t(static_cast<unsigned_type>(static_cast<unsigned_type>(*iter) -
+                                                          static_cast<unsigned_type>(minVal))) >> shift;
+        if (bucket <= target)
+            selected.push_back(*iter);
+    }
+    assert(selected.size() == (below + counts[target]));
+    return true;
+}
+
+template <typename RandomAccessIter, typename Compare>
+void top_k_select(RandomAccessIter first, RandomAccessIter last, size_t k, Compare & comp,
+                  std::vector<typename std::iterator_traits<RandomAccessIter>::value_type> & selected,
+                  std::false_type /* histogram */) {
+    selected.assign(first, last);
+    jstd::partial_sort(selected.begin(), selected.begin() + k, selected.end(), comp);
+    selected.resize(k);
+}
+
+template <typename RandomAccessIter, typename Compare>
+void top_k_select(RandomAccessIter first, RandomAccessIter last, size_t k, Compare & comp,
+                  std::vector<typename std::iterator_traits<RandomAccessIter>::value_type> & selected,
+                  std::true_type /* histogram */) {
+    if (size_t(last - first) < kHistogramSelectThreshold ||
+        !histogram_select_copy(first, last, k, selected)) {
+        top_k_select(first, last, k, comp, selected, std::false_type());
+        return;
+    }
+    jstd::partial_sort(selected.begin(), selected.begin() + k, selected.end(), comp);
+    selected.resize(k);
+}
+
+template <typename T, typename Compare>
+struct UseHistogramSelect
+    : std::integral_constant<bool, std::is_integral<T>::value &&
+                                   !std::is_same<T, bool>::value &&
+                                   is_less_compare<T, Compare>::value> {};
+
+} // namespace partial_detail
+
+//
+// The k-th element is at nth, the elements before nth are not greater,
+// the elements after nth are not less.
+//
+template <typename RandomAccessIter, typename Compare>
+void nth_element(RandomAccessIter first, RandomAccessIter nth, RandomAccessIter last, Compare comp) {
+    if (unlikely(nth == last || (last - first) <= 1))
+        return;
+    partial_detail::floyd_rivest_select(first, nth, last, comp);
+}
+
+template <typename RandomAccessIter>
+void nth_element(RandomAccessIter first, RandomAccessIter nth, RandomAccessIter last) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type T;
+    jstd::nth_element(first, nth, last, std::less<T>());
+}
+
+//
+// [first, middle) is the sorted (middle - first) smallest elements of [first, last),
+// the order of [middle, last) is unspecified.
+//
+template <typename RandomAccessIter, typename Compare>
+void partial_sort(RandomAccessIter first, RandomAccessIter middle, RandomAccessIter last, Compare comp) {
+    size_t k = static_cast<size_t>(middle - first);
+    if (unlikely(k == 0))
+        return;
+    if (k <= partial_detail::kHeapSelectMaxK) {
+        partial_detail::heap_partial_sort(first, middle, last, comp);
+    } else if (middle != last) {
+        jstd::nth_element(first, middle - 1, last, comp);
+        orlp::pdqsort(first, middle - 1, comp);
+    } else {
+        orlp::pdqsort(first, last, comp);
+    }
+}
+
+template <typename RandomAccessIter>
+void partial_sort(RandomAccessIter first, RandomAccessIter middle, RandomAccessIter last) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type T;
+    jstd::partial_sort(first, middle, last, std::less<T>());
+}
+
+//
+// Write the sorted k smallest elements of [first, last) to out, [first, last) is not changed.
+// Use std::greater<T>() for the k largest elements. Return the end of the output.
+//
+template <typename RandomAccessIter, typename OutputIter, typename Compare>
+OutputIter top_k(RandomAccessIter first, RandomAccessIter last, size_t k, OutputIter out, Compare comp) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type value_type;
+    typedef typename std::decay<Compare>::type compare_type;
+
+    size_t length = static_cast<size_t>(last - first);
+    k = (k < length) ? k : length;
+    if (unlikely(k == 0))
+        return out;
+
+    std::vector<value_type> selected;
+    if (k <= partial_detail::kHeapSelectMaxK) {
+        selected.assign(first, first + k);
+        std::make_heap(selected.begin(), selected.end(), comp);
+        partial_detail::heap_select_scan(selected.begin(), ptrdiff_t(k), first + k, last, comp,
+            std::false_type(), partial_detail::UseSelectFilter<value_type, compare_type>());
+        std::sort_heap(selected.begin(), selected.end(), comp);
+    } else {
+        partial_detail::top_k_select(first, last, k, comp, selected,
+            partial_detail::UseHistogramSelect<value_type, compare_type>());
+    }
+    return std::move(selected.begin(), selected.end(), out);
+}
+
+template <typename RandomAccessIter, typename OutputIter>
+OutputIter top_k(RandomAccessIter first, RandomAccessIter last, size_t k, OutputIter out) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type T;
+    return jstd::top_k(first, last, k, out, std::less<T>());
+}
+
+} // namespace jstd
+
+#endif // !JSTD_PARTIAL_SORT_H
@@ -0,0 +1,218 @@
+
+#ifndef JSTD_QUAD_SMALL_SORT_H
+#define JSTD_QUAD_SMALL_SORT_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+#include "jstd/algorithms/InsertSort.h"
+#include "jstd/algorithms/orlp-pdqsort.h"
+#include "jstd/support/IteratorTraits.h"
+
+#include <assert.h>
+
+#include <cstddef>
+#include <cstring>      // For std::memcpy()
+#include <iterator>
+#include <functional>   // For std::less<T>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+//
+// The small array sort in the style of quadsort, for 32 - 256 elements.
+//
+// jstd::quad_small_sort(first, last): the blocks of 4 elements are sorted by a branchless
+// sorting network, then the runs are merged bottom-up between the array and a scratch
+// buffer on the stack. Two runs of the same length are merged by a parity merge,
+// a bidirectional merge: the head merge takes the smaller half from the front and the
+// tail merge takes the greater half from the back in the same loop, both branchless,
+// so the loop has no bound check. Two runs already in order are only copied.
+//
+// The trivially copyable values (at most kQuadMaxValueSize bytes) on the contiguous storage
+// use it, the other values use jstd::insert_sort(). The arrays longer than
+// kQuadSmallSortMaxLength use orlp::pdqsort(). It's not stable.
+//
+namespace jstd {
+namespace quad_detail {
+
+// The max length of the array sorted by quad_small_sort(), the size of the scratch buffer
+static const size_t kQuadSmallSortMaxLength = 256;
+
+// The max size of the values of the quad merge
+static const size_t kQuadMaxValueSize = 16;
+
+template <typename T, typename Comparer>
+JSTD_FORCED_INLINE
+void compare_swap(T * a, T * b, Comparer & compare) {
+    bool swap = compare(*b, *a);
+    T lo = swap ? *b : *a;
+    T hi = swap ? *a : *b;
+    *a = lo;
+    *b = hi;
+}
+
+template <typename T, typename Comparer>
+JSTD_FORCED_INLINE
+void sort4(T * p, Comparer & compare) {
+    compare_swap(p + 0, p + 1, compare);
+    compare_swap(p + 2, p + 3, compare);
+    compare_swap(p + 0, p + 2, compare);
+    compare_swap(p + 1, p + 3, compare);
+    compare_swap(p + 1, p + 2, compare);
+}
+
+//
+// Merge two runs of length half in src to dest, half steps from the front and half steps
+// from the back. The head takes the left one of the equal values and the tail takes
+// the right one, so both meet in the middle.
+//
+template <typename T, typename Comparer>
+JSTD_FORCED_INLINE
+void parity_merge(T * dest, const T * src, size_t half, Comparer & compare) {
+    const T * left = src;
+    const T * right = src + half;
+    const T * left_tail = src + half - 1;
+    const T * right_tail = src + half * 2 - 1;
+    T * head = dest;
+    T * tail = dest + half * 2 - 1;
+
+    for (size_t i = 0; i < half; i++) {
+        bool take_left = !compare(*right, *left);
+        *head++ = take_left ? *left : *right;
+        left += take_left;
+        right += !take_left;
+
+        bool take_left_tail = compare(*right_tail, *left_tail);
+        *tail-- = take_left_tail ? *left_tail : *right_tail;
+        left_tail -= take_left_tail;
+        right_tail -= !take_left_tail;
+    }
+}
+
+//
+// Merge the runs of any length, branchless, with the bound check.
+//
+template <typename T, typename Comparer>
+JSTD_FORCED_INLINE
+void bounded_merge(T * dest, const T * src, size_t left_len, size_t right_len,
+                   Comparer & compare) {
+    const T * left = src;
+    const T * left_last = src + left_len;
+    const T * right = left_last;
+    const T * right_last = right + right_len;
+
+    while (left != left_last && right != right_last) {
+        bool take_left = !compare(*right, *left);
+        *dest++ = take_left ? *left : *right;
+        left += take_left;
+        right += !take_left;
+    }
+    std::memcpy((void *)dest, (const void *)left, (left_last - left) * sizeof(T));
+    dest += (left_last - left);
+    std::memcpy((void *)dest, (const void *)right, (right_last - right) * sizeof(T));
+}
+
+template <typename T, typename Comparer>
+void quad_small_sort(T * data, size_t length, Comparer compare) {
+    assert(length <= kQuadSmallSortMaxLength);
+
+    if (length < 8) {
+        jstd::insert_sort(data, data + length, compare);
+        return;
+    }
+
+    size_t blocks = length & ~size_t(3);
+    for (size_t i = 0; i < blocks; i += 4) {
+        sort4(data + i, compare);
+    }
+    if (blocks != length) {
+        jstd::insert_sort(data + blocks, data + length, compare);
+    }
+
+    typename std::aligned_storage<sizeof(T) * kQuadSmallSortMaxLength,
+                                  std::alignment_of<T>::value>::type storage;
+    T * buffer = reinterpret_cast<T *>(&storage);
+    T * src = data;
+    T * dest = buffer;
+
+    for (size_t width = 4; width < length; width *= 2) {
+        for (size_t i = 0; i < length; i += width * 2) {
+            size_t left_len = (std::min)(width, length - i);
+            size_t right_len = (std::min)(width, length - i - left_len);
+            if (right_len == 0 || !compare(src[i + left_len], src[i + left_len - 1])) {
+                std::memcpy((void *)(dest + i), (const void *)(src + i),
+                            (left_len + right_len) * sizeof(T));
+            } else if (right_len == width) {
+                parity_merge(dest + i, src + i, width, compare);
+            } else {
+                bounded_merge(dest + i, src + i, left_len, right_len, compare);
+            }
+        }
+        std::swap(src, dest);
+    }
+
+    if (src != data) {
+        std::memcpy((void *)data, (const void *)src, length * sizeof(T));
+    }
+}
+
+template <typename RandomAccessIter, typename Comparer>
+inline void quad_small_sort(RandomAccessIter first, RandomAccessIter last,
+                            Comparer compare, std::true_type) {
+    quad_small_sort(&*first, static_cast<size_t>(last - first), compare);
+}
+
+template <typename RandomAccessIter, typename Comparer>
+inline void quad_small_sort(RandomAccessIter first, RandomAccessIter last,
+                            Comparer compare, std::false_type) {
+    jstd::insert_sort(first, last, compare);
+}
+
+} // namespace quad_detail
+
+template <typename RandomAccessIter, typename Comparer>
+inline void quad_small_sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type T;
+    typedef std::integral_constant<bool, std::is_trivially_copyable<T>::value &&
+                                         (sizeof(T) <= quad_detail::kQuadMaxValueSize) &&
+                                         is_contiguous_iterator<RandomAccessIter, T>::value> use_quad;
+
+    size_t length = static_cast<size_t>(last - first);
+    if (unlikely(length < 2))
+        return;
+    if (likely(length <= quad_detail::kQuadSmallSortMaxLength))
+        quad_detail::quad_small_sort(first, last, compare, use_quad());
+    else
+        orlp::pdqsort(first, last, compare);
+}
+
+template <typename RandomAccessIter>
+inline void quad_small_sort(RandomAccessIter first, RandomAccessIter last) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type T;
+    quad_small_sort(first, last, std::less<T>());
+}
+
+//
+// The small sorter of histogram_sort_tuned() and sgi::intro_sort_tuned(), see jstd::InsertSorter.
+// The partitions are sorted one by one, the unguarded insertion only finishes the others.
+//
+struct QuadSmallSorter {
+    static const bool kSortPartitions = true;
+
+    template <typename RandomAccessIter, typename Comparer>
+    static void sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+        jstd::quad_small_sort(first, last, compare);
+    }
+
+    template <typename RandomAccessIter, typename Comparer>
+    static void unguarded_sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+        insert_detail::unguarded_insert_sort(first, last, compare);
+    }
+};
+
+} // namespace jstd
+
+#endif // !JSTD_QUAD_SMALL_SORT_H
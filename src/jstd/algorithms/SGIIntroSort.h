@@ -258,18 +258,37 @@ inline void unguarded_insertion_sort(RandomAccessIter first, RandomAccessIter la
     }
 }
 
-template <typename RandomAccessIter, typename Comparer>
-inline void final_insertion_sort(RandomAccessIter first, RandomAccessIter last,
-                                 Comparer compare) {
+// The SGI linear insertion, the default small sorter.
+struct LinearInsertSorter {
+    static const bool kSortPartitions = false;
+
+    template <typename RandomAccessIter, typename Comparer>
+    static void sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+        insertion_sort(first, last, compare);
+    }
+
+    template <typename RandomAccessIter, typename Comparer>
+    static void unguarded_sort(RandomAccessIter first, RandomAccessIter last, Comparer compare) {
+        unguarded_insertion_sort(first, last, compare);
+    }
+};
+
+//
+// The final pass by SmallSorter: after intro_sort_loop(), the minimum is in the first
+// kInsertSortThreshold elements, it's the sentinel of the unguarded sort of the others.
+//
+template <typename SmallSorter, typename RandomAccessIter, typename Comparer>
+inline void final_small_sort(RandomAccessIter first, RandomAccessIter last,
+                             Comparer compare) {
     typedef RandomAccessIter iterator;
     typedef typename std::iterator_traits<iterator>::difference_type diff_type;
 
     diff_type length = last - first;
     if (size_t(length) > kInsertSortThreshold) {
-        insertion_sort(first, first + kInsertSortThreshold, compare);
-        unguarded_insertion_sort(first + kInsertSortThreshold, last, compare);
+        SmallSorter::sort(first, first + kInsertSortThreshold, compare);
+        SmallSorter::unguarded_sort(first + kInsertSortThreshold, last, compare);
     } else {
-        insertion_sort(first, last, compare);
+        SmallSorter::sort(first, last, compare);
     }
 }
 
@@ -310,7 +329,7 @@ inline void partial_sort(RandomAccessIter first, RandomAccessIter middle,
     std::sort_heap(first, middle, compare);
 }
 
-template <typename RandomAccessIter, typename Comparer>
+template <typename SmallSorter, typename RandomAccessIter, typename Comparer>
 inline void intro_sort_loop(RandomAccessIter first, RandomAccessIter last,
                             Comparer compare, size_t depth) {
     typedef RandomAccessIter iterator;
@@ -324,19 +343,25 @@ inline void intro_sort_loop(RandomAccessIter first, RandomAccessIter last,
             //value_type mean = *mean3_iter(first, last);
             iterator pivot = unguarded_partition(first, last, mean, compare);
 
-            intro_sort_loop(first, pivot, compare, depth);
+            intro_sort_loop<SmallSorter>(first, pivot, compare, depth);
             // intro_sort_loop(pivot + 1, last, compare, depth);
 
-            first = std::next(pivot);
+            // The element at pivot is not in place, the final pass inserts it,
+            // it's kept in the partition if there is no final pass.
+            first = SmallSorter::kSortPartitions ? pivot : std::next(pivot);
         } else {
             // Change to heap sort
             partial_sort(first, last, compare);
             return;
         }
     }
+
+    if (SmallSorter::kSortPartitions) {
+        SmallSorter::sort(first, last, compare);
+    }
 }
 
-template <typename RandomAccessIter, typename Comparer>
+template <typename SmallSorter, typename RandomAccessIter, typename Comparer>
 inline void intro_sort(RandomAccessIter first, RandomAccessIter last,
                        Comparer compare, std::random_access_iterator_tag) {
     typedef RandomAccessIter iterator;
@@ -349,12 +374,13 @@ inline void intro_sort(RandomAccessIter first, RandomAccessIter last,
         assert(log2N >= 1);
         size_t depth = 2 * log2N;
         // When depth >= 2 * log2(N), change to heap sort.
-        intro_sort_loop(first, last, compare, depth);
-        final_insertion_sort(first, last, compare);
+        intro_sort_loop<SmallSorter>(first, last, compare, depth);
+        if (!SmallSorter::kSortPartitions)
+            final_small_sort<SmallSorter>(first, last, compare);
     }
 }
 
-template <typename BiDirectionalIter, typename Comparer>
+template <typename SmallSorter, typename BiDirectionalIter, typename Comparer>
 inline void intro_sort(BiDirectionalIter first, BiDirectionalIter last,
                        Comparer compare, std::bidirectional_iterator_tag) {
     typedef BiDirectionalIter iterator;
@@ -363,7 +389,7 @@ inline void intro_sort(BiDirectionalIter first, BiDirectionalIter last,
                   "sgi_intro_detail::intro_sort() is not supported std::bidirectional_iterator.");
 }
 
-template <typename ForwardIter, typename Comparer>
+template <typename SmallSorter, typename ForwardIter, typename Comparer>
 inline void intro_sort(ForwardIter first, ForwardIter last,
                        Comparer compare, std::forward_iterator_tag) {
     typedef ForwardIter iterator;
@@ -384,7 +410,7 @@ inline void intro_sort(ForwardIter first, ForwardIter last,
 template <typename Iterator, typename Comparer>
 void intro_sort(Iterator first, Iterator last, Comparer compare) {
     typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
-    intro_detail::intro_sort(first, last, compare, iterator_category());
+    intro_detail::intro_sort<intro_detail::LinearInsertSorter>(first, last, compare, iterator_category());
 }
 
 template <typename Iterator>
@@ -393,6 +419,23 @@ void intro_sort(Iterator first, Iterator last) {
     intro_sort(first, last, std::less<T>());
 }
 
+//
+// intro_sort() with the final pass of the short partitions set by SmallSorter,
+// jstd::InsertSorter, jstd::SentinelInsertSorter, jstd::PairInsertSorter
+// or jstd::QuadSmallSorter.
+//
+template <typename SmallSorter, typename Iterator, typename Comparer>
+void intro_sort_tuned(Iterator first, Iterator last, Comparer compare) {
+    typedef typename std::iterator_traits<Iterator>::iterator_category iterator_category;
+    intro_detail::intro_sort<SmallSorter>(first, last, compare, iterator_category());
+}
+
+template <typename SmallSorter, typename Iterator>
+void intro_sort_tuned(Iterator first, Iterator last) {
+    typedef typename std::iterator_traits<Iterator>::value_type T;
+    intro_sort_tuned<SmallSorter>(first, last, std::less<T>());
+}
+
 } // namespace sgi
 
 #endif // !JSTD_SGI_INTRO_SORT_H
@@ -0,0 +1,126 @@
+
+#ifndef JSTD_SEGMENTED_SORT_H
+#define JSTD_SEGMENTED_SORT_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+#include "jstd/support/TaskPool.h"
+#include "jstd/algorithms/BatchSort.h"
+#include "jstd/algorithms/ParallelSort.h"
+#include "jstd/algorithms/orlp-pdqsort.h"
+
+#include <assert.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <memory>       // For std::unique_ptr<T>
+#include <vector>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+//
+// Segmented sort over CSR-packed arrays:
+//
+//   segment i is keys[segment_offsets[i], segment_offsets[i + 1]).
+//
+// Consecutive small segments are packed into batches of about kBatchItems elements,
+// each batch is one task that runs jstd::sort_batch(). A segment longer than
+// kParallelThreshold is sorted by all the threads of the pool with jstd::parallel_sort().
+// The waiting thread keeps running the batch tasks, so the large segments and
+// the batches balance each other over the pool.
+//
+namespace jstd {
+namespace segmented_detail {
+
+// The number of elements sorted by one batch task
+static const size_t kBatchItems = 32 * 1024;
+
+// The segments longer than it are sorted by the whole pool
+static const size_t kParallelThreshold = 256 * 1024;
+
+template <typename T, typename OffsetType, typename Comparer>
+inline void segmented_sort(T * keys, const OffsetType * segment_offsets, size_t segment_count,
+                           Comparer compare, TaskPool & pool) {
+    TaskGroup group;
+    size_t batch_first = 0;
+    size_t batch_items = 0;
+
+    for (size_t i = 0; i < segment_count; i++) {
+        size_t length = static_cast<size_t>(segment_offsets[i + 1] - segment_offsets[i]);
+        if (unlikely(length > kParallelThreshold)) {
+            continue;
+        }
+        if (batch_items == 0)
+            batch_first = i;
+        batch_items += length;
+        bool is_last = ((i + 1) == segment_count);
+        size_t next_length = (!is_last) ? static_cast<size_t>(segment_offsets[i + 2] - segment_offsets[i + 1]) : 0;
+        if (batch_items >= kBatchItems || is_last || next_length > kParallelThreshold) {
+            const OffsetType * offsets = segment_offsets + batch_first;
+            size_t count = i + 1 - batch_first;
+            pool.submit(group, [keys, offsets, count, compare]() {
+                jstd::sort_batch(offsets, keys, count, compare);
+            });
+            batch_items = 0;
+        }
+    }
+
+    // The large segments, each one uses the whole pool.
+    for (size_t i = 0; i < segment_count; i++) {
+        size_t length = static_cast<size_t>(segment_offsets[i + 1] - segment_offsets[i]);
+        if (unlikely(length > kParallelThreshold)) {
+            jstd::parallel_sort(keys + segment_offsets[i], keys + segment_offsets[i + 1], compare, pool);
+        }
+    }
+
+    pool.wait(group);
+}
+
+} // namespace segmented_detail
+
+template <typename T, typename OffsetType, typename Comparer>
+void segmented_sort(T * keys, const OffsetType * segment_offsets, size_t segment_count,
+                    Comparer compare, TaskPool & pool) {
+    static_assert(std::is_integral<OffsetType>::value,
+                  "jstd::segmented_sort(): OffsetType must be a integral type.");
+    if (likely(segment_count != 0))
+        segmented_detail::segmented_sort(keys, segment_offsets, segment_count, compare, pool);
+}
+
+template <typename T, typename OffsetType>
+void segmented_sort(T * keys, const OffsetType * segment_offsets, size_t segment_count,
+                    TaskPool & pool) {
+    segmented_sort(keys, segment_offsets, segment_count, std::less<T>(), pool);
+}
+
+//
+// segment_offsets.size() is (segment count + 1), the last offset is keys.size().
+//
+template <typename T, typename OffsetType, typename Comparer>
+void segmented_sort(std::vector<T> & keys, const std::vector<OffsetType> & segment_offsets,
+                    Comparer compare, TaskPool & pool) {
+    if (likely(segment_offsets.size() > 1)) {
+        assert(static_cast<size_t>(segment_offsets.back()) <= keys.size());
+        segmented_sort(keys.data(), segment_offsets.data(), segment_offsets.size() - 1, compare, pool);
+    }
+}
+
+template <typename T, typename OffsetType>
+void segmented_sort(std::vector<T> & keys, const std::vector<OffsetType> & segment_offsets,
+                    TaskPool & pool) {
+    segmented_sort(keys, segment_offsets, std::less<T>(), pool);
+}
+
+template <typename T, typename OffsetType>
+void segmented_sort(std::vector<T> & keys, const std::vector<OffsetType> & segment_offsets) {
+    segmented_sort(keys, segment_offsets, std::less<T>(), jstd::default_task_pool());
+}
+
+} // namespace jstd
+
+#endif // !JSTD_SEGMENTED_SORT_H
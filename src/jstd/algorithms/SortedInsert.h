@@ -0,0 +1,219 @@
+
+#ifndef JSTD_SORTED_INSERT_H
+#define JSTD_SORTED_INSERT_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+#include "jstd/algorithms/InsertSort.h"
+#include "jstd/algorithms/orlp-pdqsort.h"
+#include "jstd/algorithms/ska_sort.hpp"
+
+#include <assert.h>
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include <functional>   // For std::less<T>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+//
+// Keep an array sorted while the batches of the new values are appended.
+//
+// jstd::sorted_insert_batch(sorted, first, last): the batch is sorted alone and merged
+// into the sorted array from the back, O(n + b log b) rather than O(n log n) of re-sorting
+// the whole array. The values of the batch are inserted after the equal old values,
+// the order of the equal values in the batch is not kept.
+//
+//   Tiny batches (b <= kBinaryInsertMaxBatch): each value of the batch is inserted by
+//     the search of binary_insert_sort_v2(), a binary search narrowed to a short range,
+//     which is scanned linearly, then the old values after it are moved once.
+//
+//   The other batches: a backward merge by galloping, the runs of the old values and
+//     the runs of the batch are found by an exponential search from the back, so a batch
+//     of a few long runs between the old values costs O(b log(n / b)) compares.
+//
+namespace jstd {
+namespace sorted_insert_detail {
+
+// The max size of the batch of the binary insert
+static const size_t kBinaryInsertMaxBatch = 16;
+
+// The threshold of built-in insertion sort of the batch
+static const size_t kInsertSortThreshold = 32;
+
+// The max distance of the linear scan of the binary search
+static const ptrdiff_t kLinearSearchThreshold = 16;
+
+template <typename T, typename Compare>
+struct is_radix_sortable : std::integral_constant<bool,
+                           std::is_arithmetic<T>::value &&
+                           std::is_same<Compare, std::less<T>>::value> {};
+
+template <typename RandomAccessIter, typename Compare>
+void sort_batch(RandomAccessIter first, RandomAccessIter last, Compare comp, std::false_type) {
+    orlp::pdqsort(first, last, comp);
+}
+
+template <typename RandomAccessIter, typename Compare>
+void sort_batch(RandomAccessIter first, RandomAccessIter last, Compare comp, std::true_type) {
+    ska_sort(first, last);
+}
+
+//
+// The first element in [first, last) which is greater than value, as binary_insert_sort_v2():
+// the binary search stops at a range of kLinearSearchThreshold, which is scanned from the back.
+//
+template <typename RandomAccessIter, typename T, typename Compare>
+RandomAccessIter upper_bound(RandomAccessIter first, RandomAccessIter last,
+                             const T & value, Compare comp) {
+    typedef typename std::iterator_traits<RandomAccessIter>::difference_type diff_type;
+
+    diff_type distance = last - first;
+    while (distance > kLinearSearchThreshold) {
+        RandomAccessIter mid = first + distance / 2;
+        if (comp(value, *mid)) {
+            last = mid;
+        } else {
+            first = std::next(mid);
+        }
+        distance = last - first;
+    }
+    while (last != first && comp(value, *std::prev(last))) {
+        --last;
+    }
+    return last;
+}
+
+//
+// The first element in [first, last) which is greater than value (or not less than value,
+// if Upper is false), by an exponential search from the back.
+//
+template <bool Upper, typename RandomAccessIter, typename T, typename Compare>
+RandomAccessIter gallop_from_back(RandomAccessIter first, RandomAccessIter last,
+                                  const T & value, Compare comp) {
+    typedef typename std::iterator_traits<RandomAccessIter>::difference_type diff_type;
+
+    diff_type distance = last - first;
+    diff_type step = 1;
+    RandomAccessIter hi = last;
+    // Find the range (last - step, last - step / 2], the bound is in.
+    while (step <= distance) {
+        RandomAccessIter probe = last - step;
+        bool after = Upper ? comp(value, *probe) : !comp(*probe, value);
+        if (!after) {
+            first = std::next(probe);
+            break;
+        }
+        hi = probe;
+        step *= 2;
+    }
+    if (Upper)
+        return std::upper_bound(first, hi, value, comp);
+    else
+        return std::lower_bound(first, hi, value, comp);
+}
+
+//
+// [first, middle) is the old sorted values, [middle, last) is the batch, it's sorted.
+//
+template <typename RandomAccessIter, typename Compare>
+void binary_insert_merge(RandomAccessIter first, RandomAccessIter middle, RandomAccessIter last,
+                         Compare comp) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type T;
+
+    std::vector<T> batch(std::make_move_iterator(middle), std::make_move_iterator(last));
+    RandomAccessIter hi = middle;
+    RandomAccessIter dest = last;
+    for (size_t i = batch.size(); i > 0; i--) {
+        T & value = batch[i - 1];
+        RandomAccessIter pos = sorted_insert_detail::upper_bound(first, hi, value, comp);
+        dest = std::move_backward(pos, hi, dest);
+        *--dest = std::move(value);
+        hi = pos;
+    }
+}
+
+//
+// [first, middle) is the old sorted values, [middle, last) is the batch, it's sorted.
+//
+template <typename RandomAccessIter, typename Compare>
+void gallop_merge(RandomAccessIter first, RandomAccessIter middle, RandomAccessIter last,
+                  Compare comp) {
+    typedef typename std::iterator_traits<RandomAccessIter>::value_type T;
+    typedef typename std::vector<T>::iterator buffer_iterator;
+
+    std::vector<T> batch(std::make_move_iterator(middle), std::make_move_iterator(last));
+    buffer_iterator batch_first = batch.begin();
+    buffer_iterator batch_last = batch.end();
+    RandomAccessIter hi = middle;
+    RandomAccessIter dest = last;
+    while (batch_last != batch_first && hi != first) {
+        // The old values greater than the last value of the batch.
+        RandomAccessIter pos = gallop_from_back<true>(first, hi, *std::prev(batch_last), comp);
+        dest = std::move_backward(pos, hi, dest);
+        hi = pos;
+        if (hi == first)
+            break;
+
+        // The values of the batch not less than the last old value.
+        buffer_iterator batch_pos = gallop_from_back<false>(batch_first, batch_last,
+                                                            *std::prev(hi), comp);
+        dest = std::move_backward(batch_pos, batch_last, dest);
+        batch_last = batch_pos;
+    }
+    // The old values left are in place.
+    std::move_backward(batch_first, batch_last, dest);
+}
+
+} // namespace sorted_insert_detail
+
+//
+// Insert the batch [first, last) into the sorted vector, which is sorted by comp.
+//
+template <typename T, typename Allocator, typename InputIter, typename Compare>
+void sorted_insert_batch(std::vector<T, Allocator> & sorted, InputIter first, InputIter last,
+                         Compare comp) {
+    typedef typename std::vector<T, Allocator>::iterator iterator;
+
+    size_t old_size = sorted.size();
+    sorted.insert(sorted.end(), first, last);
+    size_t batch_size = sorted.size() - old_size;
+    if (batch_size == 0)
+        return;
+
+    iterator middle = sorted.begin() + old_size;
+    if (batch_size <= sorted_insert_detail::kInsertSortThreshold) {
+        jstd::insert_sort(middle, sorted.end(), comp);
+    } else {
+        typedef typename sorted_insert_detail::is_radix_sortable<T, Compare>::type radix_tag;
+        sorted_insert_detail::sort_batch(middle, sorted.end(), comp, radix_tag());
+    }
+
+    // Already in order, the batch is after the old values.
+    if (old_size == 0 || !comp(*middle, *std::prev(middle)))
+        return;
+
+    if (batch_size <= sorted_insert_detail::kBinaryInsertMaxBatch)
+        sorted_insert_detail::binary_insert_merge(sorted.begin(), middle, sorted.end(), comp);
+    else
+        sorted_insert_detail::gallop_merge(sorted.begin(), middle, sorted.end(), comp);
+}
+
+template <typename T, typename Allocator, typename InputIter>
+void sorted_insert_batch(std::vector<T, Allocator> & sorted, InputIter first, InputIter last) {
+    jstd::sorted_insert_batch(sorted, first, last, std::less<T>());
+}
+
+template <typename T, typename Allocator, typename Container>
+void sorted_insert_batch(std::vector<T, Allocator> & sorted, const Container & batch) {
+    jstd::sorted_insert_batch(sorted, std::begin(batch), std::end(batch), std::less<T>());
+}
+
+} // namespace jstd
+
+#endif // !JSTD_SORTED_INSERT_H
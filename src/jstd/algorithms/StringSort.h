@@ -0,0 +1,314 @@
+
+#ifndef JSTD_STRING_SORT_H
+#define JSTD_STRING_SORT_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+
+#include <assert.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>      // For std::memcpy(), std::memcmp()
+#include <iterator>
+#include <vector>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <stdlib.h>     // For _byteswap_uint64()
+#endif
+
+//
+// Caching multikey quicksort for strings (std::string, or any type with data() and size()).
+//
+// The strings are sorted as an array of (cached key, pointer, length) entries.
+// The cached key is a super-character of 7 bytes of the string at the current depth,
+// stored big-endian, plus one byte of min(remaining length, 7), so one 64-bit compare
+// orders 7 characters, and a string shorter than the key is ordered before its
+// extensions, even if they continue with '\0'. The keys are loaded once per depth,
+// the < and > partitions keep them, only the = partition reloads them 7 bytes deeper.
+// The common prefix of a group is never compared again, and when a partition step finds
+// all the strings equal, their whole common prefix is skipped at once.
+//
+// The depth of every partition split is a lower bound of the LCP of the two strings
+// on the boundary, the optional LCP array is finished from these lower bounds.
+//
+namespace jstd {
+namespace string_detail {
+
+// The threshold of built-in insertion sort
+static const size_t kInsertSortThreshold = 16;
+
+// The number of characters of a cached key
+static const size_t kCacheChars = 7;
+
+struct StringEntry {
+    uint64_t        cache;
+    const uint8_t * str;
+    size_t          length;
+    size_t          index;
+};
+
+static inline
+uint64_t byte_swap64(uint64_t value) {
+#if defined(_MSC_VER)
+    return _byteswap_uint64(value);
+#else
+    return __builtin_bswap64(value);
+#endif
+}
+
+static inline
+uint64_t load_cache(const StringEntry & entry, size_t depth) {
+    size_t remain = (entry.length > depth) ? (entry.length - depth) : 0;
+    uint64_t key;
+    if (likely(remain >= 8)) {
+        std::memcpy(&key, entry.str + depth, sizeof(key));
+        key = byte_swap64(key);
+        return ((key >> 8) << 8) | kCacheChars;
+    } else {
+        key = 0;
+        for (size_t i = 0; i < remain && i < kCacheChars; i++) {
+            key |= uint64_t(entry.str[depth + i]) << (56 - i * 8);
+        }
+        return key | ((remain < kCacheChars) ? remain : kCacheChars);
+    }
+}
+
+static inline
+bool cache_is_end(uint64_t cache) {
+    return ((cache & 0xFF) < kCacheChars);
+}
+
+// Compare two strings from depth, the characters before depth are equal.
+static inline
+bool string_less(const StringEntry & a, const StringEntry & b, size_t depth) {
+    size_t a_len = a.length - depth;
+    size_t b_len = b.length - depth;
+    size_t min_len = (a_len < b_len) ? a_len : b_len;
+    int cmp = (min_len != 0) ? std::memcmp(a.str + depth, b.str + depth, min_len) : 0;
+    return (cmp < 0) || (cmp == 0 && a_len < b_len);
+}
+
+static inline
+void refresh_caches(StringEntry * entries, size_t count, size_t depth) {
+    for (size_t i = 0; i < count; i++) {
+        entries[i].cache = load_cache(entries[i], depth);
+    }
+}
+
+//
+// The caches are valid at depth, the strings are equal before depth.
+//
+static inline
+void insert_sort(StringEntry * entries, size_t count, size_t depth, size_t * lcp_lower) {
+    for (size_t i = 1; i < count; i++) {
+        StringEntry key = entries[i];
+        size_t j = i;
+        while (j > 0) {
+            const StringEntry & prev = entries[j - 1];
+            bool less;
+            if (prev.cache != key.cache)
+                less = (key.cache < prev.cache);
+            else if (cache_is_end(key.cache))
+                less = false;
+            else
+                less = string_less(key, prev, depth + kCacheChars);
+            if (!less)
+                break;
+            entries[j] = prev;
+            j--;
+        }
+        entries[j] = key;
+    }
+    if (lcp_lower != nullptr) {
+        for (size_t i = 1; i < count; i++) {
+            lcp_lower[i] = depth;
+        }
+    }
+}
+
+// The length of the common prefix of the strings after depth.
+static inline
+size_t common_prefix(const StringEntry * entries, size_t count, size_t depth) {
+    const uint8_t * ref = entries[0].str + depth;
+    size_t prefix = entries[0].length - depth;
+    for (size_t i = 1; i < count && prefix != 0; i++) {
+        const uint8_t * str = entries[i].str + depth;
+        size_t length = entries[i].length - depth;
+        size_t limit = (length < prefix) ? length : prefix;
+        size_t n = 0;
+        while (n < limit && str[n] == ref[n]) {
+            n++;
+        }
+        prefix = n;
+    }
+    return prefix;
+}
+
+static inline
+uint64_t median_of_three(uint64_t a, uint64_t b, uint64_t c) {
+    if (a < b) {
+        if (b < c) return b;
+        return (a < c) ? c : a;
+    } else {
+        if (a < c) return a;
+        return (b < c) ? c : b;
+    }
+}
+
+struct SortTask {
+    size_t first;
+    size_t count;
+    size_t depth;
+    bool   cache_valid;
+};
+
+//
+// lcp_lower[i] is the lower bound of LCP(entries[i - 1], entries[i]), it's optional.
+//
+static inline
+void multikey_quick_sort(StringEntry * entries, size_t length, size_t * lcp_lower) {
+    std::vector<SortTask> tasks;
+    tasks.push_back(SortTask { 0, length, 0, false });
+
+    while (!tasks.empty()) {
+        SortTask task = tasks.back();
+        tasks.pop_back();
+
+        StringEntry * first = entries + task.first;
+        size_t count = task.count;
+        size_t depth = task.depth;
+        if (!task.cache_valid)
+            refresh_caches(first, count, depth);
+
+        if (count <= kInsertSortThreshold) {
+            insert_sort(first, count, depth, (lcp_lower != nullptr) ? (lcp_lower + task.first) : nullptr);
+            continue;
+        }
+
+        uint64_t pivot = median_of_three(first[0].cache, first[count / 2].cache, first[count - 1].cache);
+
+        // Dutch national flag partition: [0, lt) < pivot, [lt, i) == pivot, (gt, count) > pivot
+        size_t lt = 0, i = 0, gt = count;
+        while (i < gt) {
+            uint64_t cache = first[i].cache;
+            if (cache < pivot) {
+                std::swap(first[lt], first[i]);
+                lt++;
+                i++;
+            } else if (cache > pivot) {
+                gt--;
+                std::swap(first[i], first[gt]);
+            } else {
+                i++;
+            }
+        }
+
+        if (lcp_lower != nullptr) {
+            if (lt != 0)
+                lcp_lower[task.first + lt] = depth;
+            if (gt != count)
+                lcp_lower[task.first + gt] = depth;
+        }
+
+        if (lt > 1)
+            tasks.push_back(SortTask { task.first, lt, depth, true });
+        if ((count - gt) > 1)
+            tasks.push_back(SortTask { task.first + gt, count - gt, depth, true });
+        if ((gt - lt) > 1) {
+            if (!cache_is_end(pivot)) {
+                size_t next_depth = depth + kCacheChars;
+                // All the strings are in the = partition, skip their whole common prefix.
+                if (lt == 0 && gt == count)
+                    next_depth += common_prefix(first, count, next_depth);
+                tasks.push_back(SortTask { task.first + lt, gt - lt, next_depth, false });
+            } else if (lcp_lower != nullptr) {
+                // All the strings of the = partition are equal.
+                for (size_t k = lt + 1; k < gt; k++) {
+                    lcp_lower[task.first + k] = depth;
+                }
+            }
+        }
+    }
+}
+
+template <typename Iter>
+void string_sort(Iter first, Iter last, std::vector<size_t> * lcp) {
+    typedef typename std::iterator_traits<Iter>::value_type value_type;
+
+    size_t length = static_cast<size_t>(std::distance(first, last));
+    if (lcp != nullptr) {
+        lcp->assign(length, 0);
+    }
+    if (unlikely(length <= 1))
+        return;
+
+    std::vector<StringEntry> entries(length);
+    size_t index = 0;
+    for (Iter iter = first; iter != last; ++iter) {
+        StringEntry & entry = entries[index];
+        entry.cache = 0;
+        entry.str = reinterpret_cast<const uint8_t *>(iter->data());
+        entry.length = static_cast<size_t>(iter->size());
+        entry.index = index;
+        index++;
+    }
+
+    std::vector<size_t> lcp_lower;
+    if (lcp != nullptr) {
+        lcp_lower.assign(length, 0);
+    }
+    multikey_quick_sort(entries.data(), length, (lcp != nullptr) ? lcp_lower.data() : nullptr);
+
+    if (lcp != nullptr) {
+        // Extend the lower bounds to the exact LCPs.
+        std::vector<size_t> & lcp_array = *lcp;
+        for (size_t i = 1; i < length; i++) {
+            const StringEntry & a = entries[i - 1];
+            const StringEntry & b = entries[i];
+            size_t min_len = (a.length < b.length) ? a.length : b.length;
+            size_t n = lcp_lower[i];
+            assert(n <= min_len);
+            while (n < min_len && a.str[n] == b.str[n]) {
+                n++;
+            }
+            lcp_array[i] = n;
+        }
+    }
+
+    // Move the strings into the sorted order.
+    std::vector<value_type> sorted;
+    sorted.reserve(length);
+    for (size_t i = 0; i < length; i++) {
+        Iter iter = first;
+        std::advance(iter, entries[i].index);
+        sorted.push_back(std::move(*iter));
+    }
+    std::move(sorted.begin(), sorted.end(), first);
+}
+
+} // namespace string_detail
+
+template <typename Iter>
+void string_sort(Iter first, Iter last) {
+    string_detail::string_sort(first, last, nullptr);
+}
+
+//
+// lcp[i] is the length of the longest common prefix of the sorted strings i - 1 and i,
+// lcp[0] is 0.
+//
+template <typename Iter>
+void string_sort(Iter first, Iter last, std::vector<size_t> & lcp) {
+    string_detail::string_sort(first, last, &lcp);
+}
+
+} // namespace jstd
+
+#endif // !JSTD_STRING_SORT_H
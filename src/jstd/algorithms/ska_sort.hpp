@@ -124,6 +124,79 @@ inline size_t to_unsigned_or_bool(T * ptr)
     return reinterpret_cast<size_t>(ptr);
 }
 
+// Called by the LSD radix sorts after the counting pass: key size in bytes, digit width
+// in bits, the number of digits and a bit mask of the digits which run a scatter pass.
+// The digits where all the elements fall in one bucket are skipped.
+typedef void (*RadixPassStatsHook)(size_t key_size, size_t digit_bits, size_t num_digits, size_t pass_mask);
+
+inline RadixPassStatsHook & radix_pass_stats_hook()
+{
+    static RadixPassStatsHook hook = nullptr;
+    return hook;
+}
+
+template<typename count_type, typename key_type, size_t NumDigits, size_t DigitBits, typename It, typename OutIt, typename ExtractKey>
+bool lsd_radix_sort_impl(It begin, It end, OutIt out_begin, OutIt out_end, ExtractKey && extract_key)
+{
+    static constexpr size_t NumBuckets = size_t(1) << DigitBits;
+    static constexpr key_type DigitMask = static_cast<key_type>(NumBuckets - 1);
+
+    count_type counts[NumDigits][NumBuckets] = {};
+    for (It it = begin; it != end; ++it)
+    {
+        key_type key = to_unsigned_or_bool(extract_key(*it));
+        for (size_t digit = 0; digit < NumDigits; ++digit)
+        {
+            ++counts[digit][(key >> (digit * DigitBits)) & DigitMask];
+        }
+    }
+    count_type num_elements = static_cast<count_type>(end - begin);
+    size_t pass_mask = 0;
+    for (size_t digit = 0; digit < NumDigits; ++digit)
+    {
+        count_type total = 0;
+        bool single_bucket = false;
+        for (size_t i = 0; i < NumBuckets; ++i)
+        {
+            count_type old_count = counts[digit][i];
+            single_bucket |= (old_count == num_elements);
+            counts[digit][i] = total;
+            total += old_count;
+        }
+        if (!single_bucket)
+            pass_mask |= size_t(1) << digit;
+    }
+    if (RadixPassStatsHook hook = radix_pass_stats_hook())
+        hook(sizeof(key_type), DigitBits, NumDigits, pass_mask);
+
+    bool in_buffer = false;
+    for (size_t digit = 0; digit < NumDigits; ++digit)
+    {
+        if (!(pass_mask & (size_t(1) << digit)))
+            continue;
+        count_type * digit_counts = counts[digit];
+        size_t shift = digit * DigitBits;
+        if (!in_buffer)
+        {
+            for (It it = begin; it != end; ++it)
+            {
+                size_t key = (static_cast<key_type>(to_unsigned_or_bool(extract_key(*it))) >> shift) & DigitMask;
+                out_begin[digit_counts[key]++] = std::move(*it);
+            }
+        }
+        else
+        {
+            for (OutIt it = out_begin; it != out_end; ++it)
+            {
+                size_t key = (static_cast<key_type>(to_unsigned_or_bool(extract_key(*it))) >> shift) & DigitMask;
+                begin[digit_counts[key]++] = std::move(*it);
+            }
+        }
+        in_buffer = !in_buffer;
+    }
+    return in_buffer;
+}
+
 template<size_t>
 struct SizedRadixSorter;
 
@@ -158,37 +231,7 @@ struct SizedRadixSorter<2>
     template<typename count_type, typename It, typename OutIt, typename ExtractKey>
     static bool sort_inline(It begin, It end, OutIt out_begin, OutIt out_end, ExtractKey && extract_key)
     {
-        count_type counts0[256] = {};
-        count_type counts1[256] = {};
-
-        for (It it = begin; it != end; ++it)
-        {
-            uint16_t key = to_unsigned_or_bool(extract_key(*it));
-            ++counts0[key & 0xff];
-            ++counts1[(key >> 8) & 0xff];
-        }
-        count_type total0 = 0;
-        count_type total1 = 0;
-        for (int i = 0; i < 256; ++i)
-        {
-            count_type old_count0 = counts0[i];
-            count_type old_count1 = counts1[i];
-            counts0[i] = total0;
-            counts1[i] = total1;
-            total0 += old_count0;
-            total1 += old_count1;
-        }
-        for (It it = begin; it != end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it));
-            out_begin[counts0[key]++] = std::move(*it);
-        }
-        for (OutIt it = out_begin; it != out_end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it)) >> 8;
-            begin[counts1[key]++] = std::move(*it);
-        }
-        return false;
+        return lsd_radix_sort_impl<count_type, uint16_t, 2, 8>(begin, end, out_begin, out_end, extract_key);
     }
 
     static constexpr size_t pass_count = 3;
@@ -209,62 +252,10 @@ struct SizedRadixSorter<4>
     template<typename count_type, typename It, typename OutIt, typename ExtractKey>
     static bool sort_inline(It begin, It end, OutIt out_begin, OutIt out_end, ExtractKey && extract_key)
     {
-        count_type counts0[256] = {};
-        count_type counts1[256] = {};
-        count_type counts2[256] = {};
-        count_type counts3[256] = {};
-
-        for (It it = begin; it != end; ++it)
-        {
-            uint32_t key = to_unsigned_or_bool(extract_key(*it));
-            ++counts0[key & 0xff];
-            ++counts1[(key >> 8) & 0xff];
-            ++counts2[(key >> 16) & 0xff];
-            ++counts3[(key >> 24) & 0xff];
-        }
-        count_type total0 = 0;
-        count_type total1 = 0;
-        count_type total2 = 0;
-        count_type total3 = 0;
-        for (int i = 0; i < 256; ++i)
-        {
-            count_type old_count0 = counts0[i];
-            count_type old_count1 = counts1[i];
-            count_type old_count2 = counts2[i];
-            count_type old_count3 = counts3[i];
-            counts0[i] = total0;
-            counts1[i] = total1;
-            counts2[i] = total2;
-            counts3[i] = total3;
-            total0 += old_count0;
-            total1 += old_count1;
-            total2 += old_count2;
-            total3 += old_count3;
-        }
-        for (It it = begin; it != end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it));
-            out_begin[counts0[key]++] = std::move(*it);
-        }
-        for (OutIt it = out_begin; it != out_end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it)) >> 8;
-            begin[counts1[key]++] = std::move(*it);
-        }
-        for (It it = begin; it != end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it)) >> 16;
-            out_begin[counts2[key]++] = std::move(*it);
-        }
-        for (OutIt it = out_begin; it != out_end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it)) >> 24;
-            begin[counts3[key]++] = std::move(*it);
-        }
-        return false;
+        return lsd_radix_sort_impl<count_type, uint32_t, 3, 11>(begin, end, out_begin, out_end, extract_key);
     }
 
-    static constexpr size_t pass_count = 5;
+    static constexpr size_t pass_count = 4;
 };
 template<>
 struct SizedRadixSorter<8>
@@ -281,103 +272,7 @@ struct SizedRadixSorter<8>
     template<typename count_type, typename It, typename OutIt, typename ExtractKey>
     static bool sort_inline(It begin, It end, OutIt out_begin, OutIt out_end, ExtractKey && extract_key)
     {
-        count_type counts0[256] = {};
-        count_type counts1[256] = {};
-        count_type counts2[256] = {};
-        count_type counts3[256] = {};
-        count_type counts4[256] = {};
-        count_type counts5[256] = {};
-        count_type counts6[256] = {};
-        count_type counts7[256] = {};
-
-        for (It it = begin; it != end; ++it)
-        {
-            uint64_t key = to_unsigned_or_bool(extract_key(*it));
-            ++counts0[key & 0xff];
-            ++counts1[(key >> 8) & 0xff];
-            ++counts2[(key >> 16) & 0xff];
-            ++counts3[(key >> 24) & 0xff];
-            ++counts4[(key >> 32) & 0xff];
-            ++counts5[(key >> 40) & 0xff];
-            ++counts6[(key >> 48) & 0xff];
-            ++counts7[(key >> 56) & 0xff];
-        }
-        count_type total0 = 0;
-        count_type total1 = 0;
-        count_type total2 = 0;
-        count_type total3 = 0;
-        count_type total4 = 0;
-        count_type total5 = 0;
-        count_type total6 = 0;
-        count_type total7 = 0;
-        for (int i = 0; i < 256; ++i)
-        {
-            count_type old_count0 = counts0[i];
-            count_type old_count1 = counts1[i];
-            count_type old_count2 = counts2[i];
-            count_type old_count3 = counts3[i];
-            count_type old_count4 = counts4[i];
-            count_type old_count5 = counts5[i];
-            count_type old_count6 = counts6[i];
-            count_type old_count7 = counts7[i];
-            counts0[i] = total0;
-            counts1[i] = total1;
-            counts2[i] = total2;
-            counts3[i] = total3;
-            counts4[i] = total4;
-            counts5[i] = total5;
-            counts6[i] = total6;
-            counts7[i] = total7;
-            total0 += old_count0;
-            total1 += old_count1;
-            total2 += old_count2;
-            total3 += old_count3;
-            total4 += old_count4;
-            total5 += old_count5;
-            total6 += old_count6;
-            total7 += old_count7;
-        }
-        for (It it = begin; it != end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it));
-            out_begin[counts0[key]++] = std::move(*it);
-        }
-        for (OutIt it = out_begin; it != out_end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it)) >> 8;
-            begin[counts1[key]++] = std::move(*it);
-        }
-        for (It it = begin; it != end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it)) >> 16;
-            out_begin[counts2[key]++] = std::move(*it);
-        }
-        for (OutIt it = out_begin; it != out_end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it)) >> 24;
-            begin[counts3[key]++] = std::move(*it);
-        }
-        for (It it = begin; it != end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it)) >> 32;
-            out_begin[counts4[key]++] = std::move(*it);
-        }
-        for (OutIt it = out_begin; it != out_end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it)) >> 40;
-            begin[counts5[key]++] = std::move(*it);
-        }
-        for (It it = begin; it != end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it)) >> 48;
-            out_begin[counts6[key]++] = std::move(*it);
-        }
-        for (OutIt it = out_begin; it != out_end; ++it)
-        {
-            std::uint8_t key = to_unsigned_or_bool(extract_key(*it)) >> 56;
-            begin[counts7[key]++] = std::move(*it);
-        }
-        return false;
+        return lsd_radix_sort_impl<count_type, uint64_t, 8, 8>(begin, end, out_begin, out_end, extract_key);
     }
 
     static constexpr size_t pass_count = 9;
@@ -783,6 +678,7 @@ inline It custom_std_partition(It begin, It end, F && func)
     return begin;
 }
 
+template<typename count_type = size_t>
 struct PartitionInfo
 {
     PartitionInfo()
@@ -792,10 +688,10 @@ struct PartitionInfo
 
     union
     {
-        size_t count;
-        size_t offset;
+        count_type count;
+        count_type offset;
     };
-    size_t next_offset;
+    count_type next_offset;
 };
 
 template<size_t>
@@ -1047,23 +943,45 @@ inline void StdSortFallback(It begin, It end, ExtractKey & extract_key)
     std::sort(begin, end, [&](auto && l, auto && r){ return extract_key(l) < extract_key(r); });
 }
 
-template<std::ptrdiff_t StdSortThreshold, typename It, typename ExtractKey>
+// The compile-time tuning of ska_sort():
+//   StdSortThreshold:          the buckets smaller than it are sorted by small_sort(),
+//   AmericanFlagSortThreshold: the buckets smaller than it use american_flag_sort(),
+//                              the bigger ones use ska_byte_sort(),
+//   count_type:                the counter type of the bucket partitions, it must hold
+//                              the size of the whole range.
+struct DefaultSortPolicy
+{
+    static constexpr std::ptrdiff_t StdSortThreshold = 128;
+    static constexpr std::ptrdiff_t AmericanFlagSortThreshold = 1024;
+
+    typedef size_t count_type;
+
+    template<typename It, typename ExtractKey>
+    static void small_sort(It begin, It end, ExtractKey & extract_key)
+    {
+        StdSortFallback(begin, end, extract_key);
+    }
+};
+
+template<typename Policy, typename It, typename ExtractKey>
 inline bool StdSortIfLessThanThreshold(It begin, It end, std::ptrdiff_t num_elements, ExtractKey & extract_key)
 {
     if (num_elements <= 1)
         return true;
-    if (num_elements >= StdSortThreshold)
+    if (num_elements >= Policy::StdSortThreshold)
         return false;
-    StdSortFallback(begin, end, extract_key);
+    Policy::small_sort(begin, end, extract_key);
     return true;
 }
 
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey, typename SubKeyType = typename CurrentSubKey::sub_key_type>
+template<typename Policy, typename CurrentSubKey, typename SubKeyType = typename CurrentSubKey::sub_key_type>
 struct InplaceSorter;
 
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey, size_t NumBytes, size_t Offset = 0>
+template<typename Policy, typename CurrentSubKey, size_t NumBytes, size_t Offset = 0>
 struct UnsignedInplaceSorter
 {
+    typedef typename Policy::count_type count_type;
+
     static constexpr size_t ShiftAmount = (((NumBytes - 1) - Offset) * 8);
     template<typename T>
     inline static uint8_t current_byte(T && elem, void * sort_data)
@@ -1073,7 +991,7 @@ struct UnsignedInplaceSorter
     template<typename It, typename ExtractKey>
     static void sort(It begin, It end, std::ptrdiff_t num_elements, ExtractKey & extract_key, void (*next_sort)(It, It, std::ptrdiff_t, ExtractKey &, void *), void * sort_data)
     {
-        if (num_elements < AmericanFlagSortThreshold)
+        if (num_elements < Policy::AmericanFlagSortThreshold)
             american_flag_sort(begin, end, extract_key, next_sort, sort_data);
         else
             ska_byte_sort(begin, end, extract_key, next_sort, sort_data);
@@ -1082,17 +1000,17 @@ struct UnsignedInplaceSorter
     template<typename It, typename ExtractKey>
     static void american_flag_sort(It begin, It end, ExtractKey & extract_key, void (*next_sort)(It, It, std::ptrdiff_t, ExtractKey &, void *), void * sort_data)
     {
-        PartitionInfo partitions[256];
+        PartitionInfo<count_type> partitions[256];
         for (It it = begin; it != end; ++it)
         {
             ++partitions[current_byte(extract_key(*it), sort_data)].count;
         }
-        size_t total = 0;
+        count_type total = 0;
         uint8_t remaining_partitions[256];
         int num_partitions = 0;
         for (int i = 0; i < 256; ++i)
         {
-            size_t count = partitions[i].count;
+            count_type count = partitions[i].count;
             if (!count)
                 continue;
             partitions[i].offset = total;
@@ -1104,14 +1022,14 @@ struct UnsignedInplaceSorter
         if (num_partitions > 1)
         {
             uint8_t * current_block_ptr = remaining_partitions;
-            PartitionInfo * current_block = partitions + *current_block_ptr;
+            PartitionInfo<count_type> * current_block = partitions + *current_block_ptr;
             uint8_t * last_block = remaining_partitions + num_partitions - 1;
             It it = begin;
             It block_end = begin + current_block->next_offset;
             It last_element = end - 1;
             for (;;)
             {
-                PartitionInfo * block = partitions + current_byte(extract_key(*it), sort_data);
+                PartitionInfo<count_type> * block = partitions + current_byte(extract_key(*it), sort_data);
                 if (block == current_block)
                 {
                     ++it;
@@ -1135,7 +1053,7 @@ struct UnsignedInplaceSorter
                 }
                 else
                 {
-                    size_t offset = block->offset++;
+                    count_type offset = block->offset++;
                     std::iter_swap(it, begin + offset);
                 }
             }
@@ -1143,16 +1061,16 @@ struct UnsignedInplaceSorter
         recurse:
         if (Offset + 1 != NumBytes || next_sort)
         {
-            size_t start_offset = 0;
+            count_type start_offset = 0;
             It partition_begin = begin;
             for (uint8_t * it = remaining_partitions, * end = remaining_partitions + num_partitions; it != end; ++it)
             {
-                size_t end_offset = partitions[*it].next_offset;
+                count_type end_offset = partitions[*it].next_offset;
                 It partition_end = begin + end_offset;
                 std::ptrdiff_t num_elements = end_offset - start_offset;
-                if (!StdSortIfLessThanThreshold<StdSortThreshold>(partition_begin, partition_end, num_elements, extract_key))
+                if (!StdSortIfLessThanThreshold<Policy>(partition_begin, partition_end, num_elements, extract_key))
                 {
-                    UnsignedInplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, NumBytes, Offset + 1>::sort(partition_begin, partition_end, num_elements, extract_key, next_sort, sort_data);
+                    UnsignedInplaceSorter<Policy, CurrentSubKey, NumBytes, Offset + 1>::sort(partition_begin, partition_end, num_elements, extract_key, next_sort, sort_data);
                 }
                 start_offset = end_offset;
                 partition_begin = partition_end;
@@ -1163,17 +1081,17 @@ struct UnsignedInplaceSorter
     template<typename It, typename ExtractKey>
     static void ska_byte_sort(It begin, It end, ExtractKey & extract_key, void (*next_sort)(It, It, std::ptrdiff_t, ExtractKey &, void *), void * sort_data)
     {
-        PartitionInfo partitions[256];
+        PartitionInfo<count_type> partitions[256];
         for (It it = begin; it != end; ++it)
         {
             ++partitions[current_byte(extract_key(*it), sort_data)].count;
         }
         uint8_t remaining_partitions[256];
-        size_t total = 0;
+        count_type total = 0;
         int num_partitions = 0;
         for (int i = 0; i < 256; ++i)
         {
-            size_t count = partitions[i].count;
+            count_type count = partitions[i].count;
             if (count)
             {
                 partitions[i].offset = total;
@@ -1187,15 +1105,15 @@ struct UnsignedInplaceSorter
         {
             last_remaining = custom_std_partition(remaining_partitions, last_remaining, [&](uint8_t partition)
             {
-                size_t & begin_offset = partitions[partition].offset;
-                size_t & end_offset = partitions[partition].next_offset;
+                count_type & begin_offset = partitions[partition].offset;
+                count_type & end_offset = partitions[partition].next_offset;
                 if (begin_offset == end_offset)
                     return false;
 
                 unroll_loop_four_times(begin + begin_offset, end_offset - begin_offset, [partitions = partitions, begin, &extract_key, sort_data](It it)
                 {
                     uint8_t this_partition = current_byte(extract_key(*it), sort_data);
-                    size_t offset = partitions[this_partition].offset++;
+                    count_type offset = partitions[this_partition].offset++;
                     std::iter_swap(it, begin + offset);
                 });
                 return begin_offset != end_offset;
@@ -1206,22 +1124,22 @@ struct UnsignedInplaceSorter
             for (uint8_t * it = remaining_partitions + num_partitions; it != remaining_partitions; --it)
             {
                 uint8_t partition = it[-1];
-                size_t start_offset = (partition == 0 ? 0 : partitions[partition - 1].next_offset);
-                size_t end_offset = partitions[partition].next_offset;
+                count_type start_offset = (partition == 0 ? 0 : partitions[partition - 1].next_offset);
+                count_type end_offset = partitions[partition].next_offset;
                 It partition_begin = begin + start_offset;
                 It partition_end = begin + end_offset;
                 std::ptrdiff_t num_elements = end_offset - start_offset;
-                if (!StdSortIfLessThanThreshold<StdSortThreshold>(partition_begin, partition_end, num_elements, extract_key))
+                if (!StdSortIfLessThanThreshold<Policy>(partition_begin, partition_end, num_elements, extract_key))
                 {
-                    UnsignedInplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, NumBytes, Offset + 1>::sort(partition_begin, partition_end, num_elements, extract_key, next_sort, sort_data);
+                    UnsignedInplaceSorter<Policy, CurrentSubKey, NumBytes, Offset + 1>::sort(partition_begin, partition_end, num_elements, extract_key, next_sort, sort_data);
                 }
             }
         }
     }
 };
 
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey, size_t NumBytes>
-struct UnsignedInplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, NumBytes, NumBytes>
+template<typename Policy, typename CurrentSubKey, size_t NumBytes>
+struct UnsignedInplaceSorter<Policy, CurrentSubKey, NumBytes, NumBytes>
 {
     template<typename It, typename ExtractKey>
     inline static void sort(It begin, It end, std::ptrdiff_t num_elements, ExtractKey & extract_key, void (*next_sort)(It, It, std::ptrdiff_t, ExtractKey &, void *), void * next_sort_data)
@@ -1261,7 +1179,7 @@ size_t CommonPrefix(It begin, It end, size_t start_index, ExtractKey && extract_
     return largest_match;
 }
 
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey, typename ListType>
+template<typename Policy, typename CurrentSubKey, typename ListType>
 struct ListInplaceSorter
 {
     using ElementSubKey = ListElementSubKey<CurrentSubKey, ListType>;
@@ -1284,15 +1202,15 @@ struct ListInplaceSorter
             return current_key(elem).size() <= current_index;
         });
         std::ptrdiff_t num_shorter_ones = end_of_shorter_ones - begin;
-        if (sort_data->next_sort && !StdSortIfLessThanThreshold<StdSortThreshold>(begin, end_of_shorter_ones, num_shorter_ones, extract_key))
+        if (sort_data->next_sort && !StdSortIfLessThanThreshold<Policy>(begin, end_of_shorter_ones, num_shorter_ones, extract_key))
         {
             sort_data->next_sort(begin, end_of_shorter_ones, num_shorter_ones, extract_key, next_sort_data);
         }
         std::ptrdiff_t num_elements = end - end_of_shorter_ones;
-        if (!StdSortIfLessThanThreshold<StdSortThreshold>(end_of_shorter_ones, end, num_elements, extract_key))
+        if (!StdSortIfLessThanThreshold<Policy>(end_of_shorter_ones, end, num_elements, extract_key))
         {
             void (*sort_next_element)(It, It, std::ptrdiff_t, ExtractKey &, void *) = static_cast<void (*)(It, It, std::ptrdiff_t, ExtractKey &, void *)>(&sort_from_recursion);
-            InplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, ElementSubKey>::sort(end_of_shorter_ones, end, num_elements, extract_key, sort_next_element, sort_data);
+            InplaceSorter<Policy, ElementSubKey>::sort(end_of_shorter_ones, end, num_elements, extract_key, sort_next_element, sort_data);
         }
     }
 
@@ -1325,8 +1243,8 @@ struct ListInplaceSorter
     }
 };
 
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey>
-struct InplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, bool>
+template<typename Policy, typename CurrentSubKey>
+struct InplaceSorter<Policy, CurrentSubKey, bool>
 {
     template<typename It, typename ExtractKey>
     static void sort(It begin, It end, std::ptrdiff_t, ExtractKey & extract_key, void (*next_sort)(It, It, std::ptrdiff_t, ExtractKey &, void *), void * sort_data)
@@ -1340,40 +1258,40 @@ struct InplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey,
     }
 };
 
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey>
-struct InplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, uint8_t> : UnsignedInplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, 1>
+template<typename Policy, typename CurrentSubKey>
+struct InplaceSorter<Policy, CurrentSubKey, uint8_t> : UnsignedInplaceSorter<Policy, CurrentSubKey, 1>
 {
 };
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey>
-struct InplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, uint16_t> : UnsignedInplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, 2>
+template<typename Policy, typename CurrentSubKey>
+struct InplaceSorter<Policy, CurrentSubKey, uint16_t> : UnsignedInplaceSorter<Policy, CurrentSubKey, 2>
 {
 };
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey>
-struct InplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, uint32_t> : UnsignedInplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, 4>
+template<typename Policy, typename CurrentSubKey>
+struct InplaceSorter<Policy, CurrentSubKey, uint32_t> : UnsignedInplaceSorter<Policy, CurrentSubKey, 4>
 {
 };
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey>
-struct InplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, uint64_t> : UnsignedInplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, 8>
+template<typename Policy, typename CurrentSubKey>
+struct InplaceSorter<Policy, CurrentSubKey, uint64_t> : UnsignedInplaceSorter<Policy, CurrentSubKey, 8>
 {
 };
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey, typename SubKeyType, typename Enable = void>
+template<typename Policy, typename CurrentSubKey, typename SubKeyType, typename Enable = void>
 struct FallbackInplaceSorter;
 
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey, typename SubKeyType>
-struct InplaceSorter : FallbackInplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, SubKeyType>
+template<typename Policy, typename CurrentSubKey, typename SubKeyType>
+struct InplaceSorter : FallbackInplaceSorter<Policy, CurrentSubKey, SubKeyType>
 {
 };
 
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey, typename SubKeyType>
-struct FallbackInplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, SubKeyType, typename std::enable_if<has_subscript_operator<SubKeyType>::value>::type>
-	: ListInplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey, SubKeyType>
+template<typename Policy, typename CurrentSubKey, typename SubKeyType>
+struct FallbackInplaceSorter<Policy, CurrentSubKey, SubKeyType, typename std::enable_if<has_subscript_operator<SubKeyType>::value>::type>
+	: ListInplaceSorter<Policy, CurrentSubKey, SubKeyType>
 {
 };
 
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey>
+template<typename Policy, typename CurrentSubKey>
 struct SortStarter;
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold>
-struct SortStarter<StdSortThreshold, AmericanFlagSortThreshold, SubKey<void>>
+template<typename Policy>
+struct SortStarter<Policy, SubKey<void>>
 {
     template<typename It, typename ExtractKey>
     static void sort(It, It, std::ptrdiff_t, ExtractKey &, void *)
@@ -1381,27 +1299,27 @@ struct SortStarter<StdSortThreshold, AmericanFlagSortThreshold, SubKey<void>>
     }
 };
 
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename CurrentSubKey>
+template<typename Policy, typename CurrentSubKey>
 struct SortStarter
 {
     template<typename It, typename ExtractKey>
     static void sort(It begin, It end, std::ptrdiff_t num_elements, ExtractKey & extract_key, void * next_sort_data = nullptr)
     {
-        if (StdSortIfLessThanThreshold<StdSortThreshold>(begin, end, num_elements, extract_key))
+        if (StdSortIfLessThanThreshold<Policy>(begin, end, num_elements, extract_key))
             return;
 
-        void (*next_sort)(It, It, std::ptrdiff_t, ExtractKey &, void *) = static_cast<void (*)(It, It, std::ptrdiff_t, ExtractKey &, void *)>(&SortStarter<StdSortThreshold, AmericanFlagSortThreshold, typename CurrentSubKey::next>::sort);
-        if (next_sort == static_cast<void (*)(It, It, std::ptrdiff_t, ExtractKey &, void *)>(&SortStarter<StdSortThreshold, AmericanFlagSortThreshold, SubKey<void>>::sort))
+        void (*next_sort)(It, It, std::ptrdiff_t, ExtractKey &, void *) = static_cast<void (*)(It, It, std::ptrdiff_t, ExtractKey &, void *)>(&SortStarter<Policy, typename CurrentSubKey::next>::sort);
+        if (next_sort == static_cast<void (*)(It, It, std::ptrdiff_t, ExtractKey &, void *)>(&SortStarter<Policy, SubKey<void>>::sort))
             next_sort = nullptr;
-        InplaceSorter<StdSortThreshold, AmericanFlagSortThreshold, CurrentSubKey>::sort(begin, end, num_elements, extract_key, next_sort, next_sort_data);
+        InplaceSorter<Policy, CurrentSubKey>::sort(begin, end, num_elements, extract_key, next_sort, next_sort_data);
     }
 };
 
-template<std::ptrdiff_t StdSortThreshold, std::ptrdiff_t AmericanFlagSortThreshold, typename It, typename ExtractKey>
+template<typename Policy, typename It, typename ExtractKey>
 void inplace_radix_sort(It begin, It end, ExtractKey & extract_key)
 {
     using SubKey = SubKey<decltype(extract_key(*begin))>;
-    SortStarter<StdSortThreshold, AmericanFlagSortThreshold, SubKey>::sort(begin, end, end - begin, extract_key);
+    SortStarter<Policy, SubKey>::sort(begin, end, end - begin, extract_key);
 }
 
 struct IdentityFunctor
@@ -1418,7 +1336,7 @@ struct IdentityFunctor
 template<typename It, typename ExtractKey>
 static void ska_sort(It begin, It end, ExtractKey && extract_key)
 {
-    ska_detail::inplace_radix_sort<128, 1024>(begin, end, extract_key);
+    ska_detail::inplace_radix_sort<ska_detail::DefaultSortPolicy>(begin, end, extract_key);
 }
 
 template<typename It>
@@ -0,0 +1,489 @@
+// Parallel in-place radix sort on top of ska_sort.hpp.
+//
+// Every radix pass counts the digits per thread, then permutes the elements in place
+// with the speculative permutation / repair rounds of PARADIS: the unfinished region
+// of every bucket is split between the threads, each thread swaps the elements into
+// its own sub-regions only, and the elements left misplaced are moved to the tail of
+// their bucket region by a partition, which is the region of the next round.
+// The buckets are sorted by the next byte as tasks of the pool, the big ones again by
+// this parallel pass, the small ones by the sequential UnsignedInplaceSorter.
+//
+// No buffer of the size of the input is allocated.
+//
+// ska_sort_copy_parallel() is the parallel LSD radix sort of ska_sort_copy(),
+// see ParallelRadixCopySorter.
+
+#pragma once
+
+#include "jstd/support/TaskPool.h"
+#include "jstd/algorithms/ska_sort.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ska_detail
+{
+
+// The ranges smaller than it are sorted by the sequential ska_sort
+static const std::ptrdiff_t kParallelRadixThreshold = 128 * 1024;
+// The number of elements of one task of small buckets
+static const std::ptrdiff_t kParallelRadixBatch = 64 * 1024;
+
+template<typename CurrentSubKey, size_t NumBytes, size_t Offset = 0>
+struct ParallelUnsignedInplaceSorter
+{
+    typedef UnsignedInplaceSorter<DefaultSortPolicy, CurrentSubKey, NumBytes, Offset> sequential_sorter;
+    typedef ParallelUnsignedInplaceSorter<CurrentSubKey, NumBytes, Offset + 1> next_sorter;
+
+    struct Regions
+    {
+        size_t head[256];
+        size_t tail[256];
+    };
+
+    template<typename T>
+    inline static uint8_t current_byte(T && elem)
+    {
+        return sequential_sorter::current_byte(elem, nullptr);
+    }
+
+    template<typename It, typename ExtractKey>
+    static void sort_sequential(It begin, It end, ExtractKey & extract_key)
+    {
+        std::ptrdiff_t num_elements = end - begin;
+        void (*next_sort)(It, It, std::ptrdiff_t, ExtractKey &, void *) = nullptr;
+        if (!StdSortIfLessThanThreshold<DefaultSortPolicy>(begin, end, num_elements, extract_key))
+            sequential_sorter::sort(begin, end, num_elements, extract_key, next_sort, nullptr);
+    }
+
+    // Permute the elements of the thread's sub-regions, the elements which have no room
+    // left in their bucket's sub-region stay where they are.
+    template<typename It, typename ExtractKey>
+    static void permute(It begin, Regions & regions, ExtractKey & extract_key)
+    {
+        size_t * head = regions.head;
+        size_t * tail = regions.tail;
+        for (int i = 0; i < 256; ++i)
+        {
+            while (head[i] < tail[i])
+            {
+                auto value = std::move(begin[head[i]]);
+                uint8_t k = current_byte(extract_key(value));
+                while (k != i && head[k] < tail[k])
+                {
+                    using std::swap;
+                    swap(value, begin[head[k]++]);
+                    k = current_byte(extract_key(value));
+                }
+                begin[head[i]++] = std::move(value);
+            }
+        }
+    }
+
+    template<typename It, typename ExtractKey>
+    static void sort(It begin, It end, ExtractKey & extract_key, jstd::TaskPool & pool, jstd::TaskGroup & sort_group)
+    {
+        std::ptrdiff_t num_elements = end - begin;
+        size_t num_threads = pool.thread_count();
+        if (num_elements < kParallelRadixThreshold || num_threads <= 1)
+        {
+            sort_sequential(begin, end, extract_key);
+            return;
+        }
+
+        // Count the digits per thread.
+        std::unique_ptr<size_t[]> thread_counts(new size_t[num_threads * 256]());
+        jstd::TaskGroup group;
+        for (size_t t = 0; t < num_threads; ++t)
+        {
+            size_t * counts = &thread_counts[t * 256];
+            It chunk_begin = begin + num_elements * t / num_threads;
+            It chunk_end = begin + num_elements * (t + 1) / num_threads;
+            pool.submit(group, [counts, chunk_begin, chunk_end, &extract_key]()
+            {
+                for (It it = chunk_begin; it != chunk_end; ++it)
+                    ++counts[current_byte(extract_key(*it))];
+            });
+        }
+        pool.wait(group);
+
+        size_t bucket_begin[257];
+        size_t bucket_head[256];
+        size_t total = 0;
+        for (int i = 0; i < 256; ++i)
+        {
+            bucket_begin[i] = total;
+            bucket_head[i] = total;
+            for (size_t t = 0; t < num_threads; ++t)
+                total += thread_counts[t * 256 + i];
+        }
+        bucket_begin[256] = total;
+
+        // Speculative permutation and repair rounds, until every bucket region is done.
+        std::unique_ptr<Regions[]> regions(new Regions[num_threads]);
+        size_t remaining = static_cast<size_t>(num_elements);
+        while (remaining != 0)
+        {
+            size_t round_threads = (remaining >= static_cast<size_t>(kParallelRadixThreshold)) ? num_threads : 1;
+            for (size_t t = 0; t < round_threads; ++t)
+            {
+                for (int i = 0; i < 256; ++i)
+                {
+                    size_t region_size = bucket_begin[i + 1] - bucket_head[i];
+                    regions[t].head[i] = bucket_head[i] + region_size * t / round_threads;
+                    regions[t].tail[i] = bucket_head[i] + region_size * (t + 1) / round_threads;
+                }
+            }
+            if (round_threads > 1)
+            {
+                for (size_t t = 0; t < round_threads; ++t)
+                {
+                    Regions * thread_regions = &regions[t];
+                    pool.submit(group, [begin, thread_regions, &extract_key]()
+                    {
+                        permute(begin, *thread_regions, extract_key);
+                    });
+                }
+                pool.wait(group);
+            }
+            else
+            {
+                permute(begin, regions[0], extract_key);
+            }
+
+            // Repair: move the misplaced elements to the tail of their bucket region.
+            for (size_t t = 0; t < num_threads; ++t)
+            {
+                int first_bucket = static_cast<int>(256 * t / num_threads);
+                int last_bucket = static_cast<int>(256 * (t + 1) / num_threads);
+                pool.submit(group, [begin, first_bucket, last_bucket, &bucket_begin, &bucket_head, &extract_key]()
+                {
+                    for (int i = first_bucket; i < last_bucket; ++i)
+                    {
+                        It middle = std::partition(begin + bucket_head[i], begin + bucket_begin[i + 1], [&](auto && elem)
+                        {
+                            return current_byte(extract_key(elem)) == i;
+                        });
+                        bucket_head[i] = static_cast<size_t>(middle - begin);
+                    }
+                });
+            }
+            pool.wait(group);
+
+            size_t last_remaining = remaining;
+            remaining = 0;
+            for (int i = 0; i < 256; ++i)
+                remaining += bucket_begin[i + 1] - bucket_head[i];
+            // A parallel round without progress, the sequential round always finishes.
+            if (remaining == last_remaining && round_threads > 1)
+            {
+                for (int i = 0; i < 256; ++i)
+                {
+                    regions[0].head[i] = bucket_head[i];
+                    regions[0].tail[i] = bucket_begin[i + 1];
+                }
+                permute(begin, regions[0], extract_key);
+                break;
+            }
+        }
+
+        if (Offset + 1 != NumBytes)
+            recurse(begin, bucket_begin, extract_key, pool, sort_group);
+    }
+
+    template<typename It, typename ExtractKey>
+    static void recurse(It begin, const size_t * bucket_begin, ExtractKey & extract_key, jstd::TaskPool & pool, jstd::TaskGroup & sort_group)
+    {
+        std::shared_ptr<std::vector<size_t>> offsets = std::make_shared<std::vector<size_t>>(bucket_begin, bucket_begin + 257);
+        auto submit_batch = [&](int first_bucket, int last_bucket)
+        {
+            if (bucket_begin[first_bucket] == bucket_begin[last_bucket])
+                return;
+            pool.submit(sort_group, [begin, offsets, first_bucket, last_bucket, &extract_key]()
+            {
+                const std::vector<size_t> & bucket_offsets = *offsets;
+                for (int i = first_bucket; i < last_bucket; ++i)
+                    next_sorter::sort_sequential(begin + bucket_offsets[i], begin + bucket_offsets[i + 1], extract_key);
+            });
+        };
+
+        // The big buckets are one task each, the small ones are batched.
+        int batch_first = 0;
+        std::ptrdiff_t batch_elements = 0;
+        for (int i = 0; i < 256; ++i)
+        {
+            std::ptrdiff_t num_elements = static_cast<std::ptrdiff_t>(bucket_begin[i + 1] - bucket_begin[i]);
+            if (num_elements >= kParallelRadixThreshold)
+            {
+                submit_batch(batch_first, i);
+                It partition_begin = begin + bucket_begin[i];
+                It partition_end = begin + bucket_begin[i + 1];
+                pool.submit(sort_group, [partition_begin, partition_end, &extract_key, &pool, &sort_group]()
+                {
+                    next_sorter::sort(partition_begin, partition_end, extract_key, pool, sort_group);
+                });
+                batch_first = i + 1;
+                batch_elements = 0;
+            }
+            else
+            {
+                batch_elements += num_elements;
+                if (batch_elements >= kParallelRadixBatch)
+                {
+                    submit_batch(batch_first, i + 1);
+                    batch_first = i + 1;
+                    batch_elements = 0;
+                }
+            }
+        }
+        submit_batch(batch_first, 256);
+    }
+};
+
+template<typename CurrentSubKey, size_t NumBytes>
+struct ParallelUnsignedInplaceSorter<CurrentSubKey, NumBytes, NumBytes>
+{
+    template<typename It, typename ExtractKey>
+    static void sort(It, It, ExtractKey &, jstd::TaskPool &, jstd::TaskGroup &)
+    {
+    }
+
+    template<typename It, typename ExtractKey>
+    static void sort_sequential(It, It, ExtractKey &)
+    {
+    }
+};
+
+template<typename SubKeyType>
+struct IsParallelRadixSubKey
+    : std::integral_constant<bool, std::is_unsigned<SubKeyType>::value && !std::is_same<SubKeyType, bool>::value>
+{
+};
+
+template<typename CurrentSubKey, typename It, typename ExtractKey>
+void parallel_radix_sort(It begin, It end, ExtractKey & extract_key, jstd::TaskPool & pool, std::true_type)
+{
+    typedef typename CurrentSubKey::sub_key_type sub_key_type;
+    jstd::TaskGroup sort_group;
+    ParallelUnsignedInplaceSorter<CurrentSubKey, sizeof(sub_key_type)>::sort(begin, end, extract_key, pool, sort_group);
+    pool.wait(sort_group);
+}
+
+template<typename CurrentSubKey, typename It, typename ExtractKey>
+void parallel_radix_sort(It begin, It end, ExtractKey & extract_key, jstd::TaskPool &, std::false_type)
+{
+    // Compound keys (pairs, tuples, lists) and bools, the sequential ska_sort.
+    inplace_radix_sort<DefaultSortPolicy>(begin, end, extract_key);
+}
+
+// The size of a write-combining line of the parallel LSD scatter
+static const size_t kScatterLineSize = 64;
+
+//
+// Parallel LSD radix sort: for every byte, the per-thread chunk histograms are merged
+// into per-thread bucket offsets (bucket-major, thread-minor prefix sums), then every
+// thread scatters its chunk. The scatter stages the elements of each bucket in a
+// cache-line sized buffer and writes out whole, aligned lines, so a thread touches one
+// line (and one page) per bucket at a time instead of one per element. The bytes whose
+// elements all fall in one bucket are skipped.
+//
+template<size_t NumBytes>
+struct ParallelRadixCopySorter
+{
+    template<typename T, typename ExtractKey>
+    inline static uint8_t current_byte(const T & elem, ExtractKey & extract_key, size_t shift)
+    {
+        return static_cast<uint8_t>(static_cast<uint64_t>(to_unsigned_or_bool(extract_key(elem))) >> shift);
+    }
+
+    template<typename T, typename ExtractKey>
+    static void scatter(const T * first, const T * last, T * dest, size_t * offsets, ExtractKey & extract_key, size_t shift, std::false_type)
+    {
+        for (; first != last; ++first)
+        {
+            uint8_t digit = current_byte(*first, extract_key, shift);
+            dest[offsets[digit]++] = *first;
+        }
+    }
+
+    template<typename T, typename ExtractKey>
+    static void scatter(const T * first, const T * last, T * dest, size_t * offsets, ExtractKey & extract_key, size_t shift, std::true_type)
+    {
+        static const size_t kLineItems = kScatterLineSize / sizeof(T);
+        alignas(64) unsigned char storage[256 * kScatterLineSize];
+        T * lines = reinterpret_cast<T *>(storage);
+        uint32_t fill[256];
+        uint32_t limit[256];
+        for (int i = 0; i < 256; ++i)
+        {
+            // The first line of a bucket ends at the cache line boundary of dest.
+            size_t misalign = (reinterpret_cast<uintptr_t>(dest + offsets[i]) % kScatterLineSize) / sizeof(T);
+            fill[i] = 0;
+            limit[i] = static_cast<uint32_t>(kLineItems - misalign);
+        }
+        for (; first != last; ++first)
+        {
+            uint8_t digit = current_byte(*first, extract_key, shift);
+            T * line = lines + digit * kLineItems;
+            line[fill[digit]++] = *first;
+            if (fill[digit] == limit[digit])
+            {
+                std::memcpy(dest + offsets[digit], line, fill[digit] * sizeof(T));
+                offsets[digit] += fill[digit];
+                fill[digit] = 0;
+                limit[digit] = static_cast<uint32_t>(kLineItems);
+            }
+        }
+        for (int i = 0; i < 256; ++i)
+        {
+            if (fill[i] != 0)
+            {
+                std::memcpy(dest + offsets[i], lines + i * kLineItems, fill[i] * sizeof(T));
+                offsets[i] += fill[i];
+            }
+        }
+    }
+
+    // Returns true if the result is in buffer.
+    template<typename T, typename ExtractKey>
+    static bool sort(T * begin, T * end, T * buffer, ExtractKey & extract_key, jstd::TaskPool & pool)
+    {
+        typedef std::integral_constant<bool, std::is_trivially_copyable<T>::value &&
+                                             (kScatterLineSize % sizeof(T)) == 0 &&
+                                             sizeof(T) * 4 <= kScatterLineSize> use_scatter_lines;
+        size_t num_elements = static_cast<size_t>(end - begin);
+        size_t num_threads = pool.thread_count();
+        std::unique_ptr<size_t[]> counts(new size_t[num_threads * 256]);
+        jstd::TaskGroup group;
+        T * src = begin;
+        T * dest = buffer;
+        bool in_buffer = false;
+
+        for (size_t shift = 0; shift < NumBytes * 8; shift += 8)
+        {
+            for (size_t t = 0; t < num_threads; ++t)
+            {
+                size_t * thread_counts = &counts[t * 256];
+                const T * first = src + num_elements * t / num_threads;
+                const T * last = src + num_elements * (t + 1) / num_threads;
+                pool.submit(group, [thread_counts, first, last, shift, &extract_key]()
+                {
+                    std::fill(thread_counts, thread_counts + 256, size_t(0));
+                    for (const T * it = first; it != last; ++it)
+                        ++thread_counts[current_byte(*it, extract_key, shift)];
+                });
+            }
+            pool.wait(group);
+
+            size_t total = 0;
+            bool single_bucket = false;
+            for (int i = 0; i < 256; ++i)
+            {
+                size_t bucket_begin = total;
+                for (size_t t = 0; t < num_threads; ++t)
+                {
+                    size_t count = counts[t * 256 + i];
+                    counts[t * 256 + i] = total;
+                    total += count;
+                }
+                if ((total - bucket_begin) == num_elements)
+                    single_bucket = true;
+            }
+            if (single_bucket)
+                continue;
+
+            for (size_t t = 0; t < num_threads; ++t)
+            {
+                size_t * offsets = &counts[t * 256];
+                const T * first = src + num_elements * t / num_threads;
+                const T * last = src + num_elements * (t + 1) / num_threads;
+                pool.submit(group, [first, last, dest, offsets, shift, &extract_key]()
+                {
+                    scatter(first, last, dest, offsets, extract_key, shift, use_scatter_lines());
+                });
+            }
+            pool.wait(group);
+
+            std::swap(src, dest);
+            in_buffer = !in_buffer;
+        }
+        return in_buffer;
+    }
+};
+
+template<typename KeyType>
+struct IsParallelCopyKey
+    : std::integral_constant<bool, (std::is_arithmetic<KeyType>::value || std::is_pointer<KeyType>::value) &&
+                                   !std::is_same<KeyType, bool>::value && sizeof(KeyType) <= 8>
+{
+};
+
+template<typename KeyType, typename It, typename OutIt, typename ExtractKey>
+bool parallel_radix_sort_copy(It begin, It end, OutIt buffer_begin, ExtractKey & extract_key, jstd::TaskPool & pool, std::true_type)
+{
+    std::ptrdiff_t num_elements = end - begin;
+    if (num_elements < kParallelRadixThreshold || pool.thread_count() <= 1)
+        return ska_sort_copy(begin, end, buffer_begin, extract_key);
+    return ParallelRadixCopySorter<sizeof(KeyType)>::sort(&*begin, &*begin + num_elements, &*buffer_begin, extract_key, pool);
+}
+
+template<typename KeyType, typename It, typename OutIt, typename ExtractKey>
+bool parallel_radix_sort_copy(It begin, It end, OutIt buffer_begin, ExtractKey & extract_key, jstd::TaskPool &, std::false_type)
+{
+    // Compound keys, the sequential ska_sort_copy.
+    return ska_sort_copy(begin, end, buffer_begin, extract_key);
+}
+
+} // namespace ska_detail
+
+template<typename It, typename ExtractKey>
+void ska_sort_parallel(It begin, It end, ExtractKey && extract_key, jstd::TaskPool & pool)
+{
+    using CurrentSubKey = ska_detail::SubKey<decltype(extract_key(*begin))>;
+    using is_parallel = std::integral_constant<bool,
+        ska_detail::IsParallelRadixSubKey<typename CurrentSubKey::sub_key_type>::value &&
+        std::is_same<typename CurrentSubKey::next, ska_detail::SubKey<void>>::value>;
+    ska_detail::parallel_radix_sort<CurrentSubKey>(begin, end, extract_key, pool, is_parallel());
+}
+
+template<typename It>
+void ska_sort_parallel(It begin, It end, jstd::TaskPool & pool)
+{
+    ska_sort_parallel(begin, end, ska_detail::IdentityFunctor(), pool);
+}
+
+template<typename It>
+void ska_sort_parallel(It begin, It end)
+{
+    ska_sort_parallel(begin, end, ska_detail::IdentityFunctor(), jstd::default_task_pool());
+}
+
+//
+// The iterators must be contiguous. Returns true if the result is in the buffer.
+//
+template<typename It, typename OutIt, typename ExtractKey>
+bool ska_sort_copy_parallel(It begin, It end, OutIt buffer_begin, ExtractKey && extract_key, jstd::TaskPool & pool)
+{
+    typedef typename std::decay<typename std::result_of<ExtractKey(decltype(*begin))>::type>::type key_type;
+    return ska_detail::parallel_radix_sort_copy<key_type>(begin, end, buffer_begin, extract_key, pool,
+                                                          ska_detail::IsParallelCopyKey<key_type>());
+}
+
+template<typename It, typename OutIt>
+bool ska_sort_copy_parallel(It begin, It end, OutIt buffer_begin, jstd::TaskPool & pool)
+{
+    return ska_sort_copy_parallel(begin, end, buffer_begin, ska_detail::IdentityFunctor(), pool);
+}
+
+template<typename It, typename OutIt>
+bool ska_sort_copy_parallel(It begin, It end, OutIt buffer_begin)
+{
+    return ska_sort_copy_parallel(begin, end, buffer_begin, ska_detail::IdentityFunctor(), jstd::default_task_pool());
+}
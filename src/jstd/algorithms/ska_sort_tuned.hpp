@@ -0,0 +1,179 @@
+// Policy presets of ska_sort().
+//
+// A policy sets the two thresholds of the in-place radix sort, the sort used for the
+// buckets smaller than StdSortThreshold and the counter type of the bucket partitions
+// (see ska_detail::DefaultSortPolicy). The recursion of ska_sort() produces many
+// buckets of 32 - 128 elements, std::sort() is slow on them.
+//
+//   ska_policy::Default:    the original ska_sort(), std::sort() below 128 elements.
+//   ska_policy::Pdqsort:    orlp::pdqsort() below 128 elements.
+//   ska_policy::Insertion:  insertion sort below 48 elements.
+//   ska_policy::Network:    sorting networks (<= 8) or insertion sort below 16 elements.
+//   ska_policy::Quad:       jstd::quad_small_sort() below 128 elements.
+//   ska_policy::L1:         american flag sort up to 8K elements (32 KB of 32-bit keys).
+//   ska_policy::L2:         american flag sort up to 64K elements (256 KB of 32-bit keys).
+//
+// All the presets but Default use 32-bit partition counters, ska_sort_tuned() switches
+// them to size_t for the ranges of 4G or more elements.
+
+#pragma once
+
+#include "jstd/algorithms/ska_sort.hpp"
+#include "jstd/algorithms/InsertSort.h"
+#include "jstd/algorithms/QuadSmallSort.h"
+#include "jstd/algorithms/orlp-pdqsort.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace ska_detail
+{
+
+struct PdqsortSmallSorter
+{
+    template<typename It, typename ExtractKey>
+    static void sort(It begin, It end, ExtractKey & extract_key)
+    {
+        orlp::pdqsort(begin, end, [&](auto && l, auto && r){ return extract_key(l) < extract_key(r); });
+    }
+};
+
+struct InsertionSmallSorter
+{
+    template<typename It, typename ExtractKey>
+    static void sort(It begin, It end, ExtractKey & extract_key)
+    {
+        jstd::insert_sort(begin, end, [&](auto && l, auto && r){ return extract_key(l) < extract_key(r); });
+    }
+};
+
+struct QuadSmallSorter
+{
+    template<typename It, typename ExtractKey>
+    static void sort(It begin, It end, ExtractKey & extract_key)
+    {
+        jstd::quad_small_sort(begin, end, [&](auto && l, auto && r){ return extract_key(l) < extract_key(r); });
+    }
+};
+
+struct NetworkSmallSorter
+{
+    template<typename It, typename ExtractKey>
+    inline static void compare_swap(It a, It b, ExtractKey & extract_key)
+    {
+        if (extract_key(*b) < extract_key(*a))
+            std::iter_swap(a, b);
+    }
+
+    template<typename It, typename ExtractKey>
+    static void sort(It begin, It end, ExtractKey & extract_key)
+    {
+        #define SKA_CMP_SWAP(i, j) compare_swap(begin + (i), begin + (j), extract_key)
+        switch (end - begin)
+        {
+        case 0:
+        case 1:
+            break;
+        case 2:
+            SKA_CMP_SWAP(0, 1);
+            break;
+        case 3:
+            SKA_CMP_SWAP(0, 2); SKA_CMP_SWAP(0, 1); SKA_CMP_SWAP(1, 2);
+            break;
+        case 4:
+            SKA_CMP_SWAP(0, 2); SKA_CMP_SWAP(1, 3);
+            SKA_CMP_SWAP(0, 1); SKA_CMP_SWAP(2, 3);
+            SKA_CMP_SWAP(1, 2);
+            break;
+        case 5:
+            SKA_CMP_SWAP(0, 3); SKA_CMP_SWAP(1, 4);
+            SKA_CMP_SWAP(0, 2); SKA_CMP_SWAP(1, 3);
+            SKA_CMP_SWAP(0, 1); SKA_CMP_SWAP(2, 4);
+            SKA_CMP_SWAP(1, 2); SKA_CMP_SWAP(3, 4);
+            SKA_CMP_SWAP(2, 3);
+            break;
+        case 6:
+            SKA_CMP_SWAP(0, 5); SKA_CMP_SWAP(1, 3); SKA_CMP_SWAP(2, 4);
+            SKA_CMP_SWAP(1, 2); SKA_CMP_SWAP(3, 4);
+            SKA_CMP_SWAP(0, 3); SKA_CMP_SWAP(2, 5);
+            SKA_CMP_SWAP(0, 1); SKA_CMP_SWAP(2, 3); SKA_CMP_SWAP(4, 5);
+            SKA_CMP_SWAP(1, 2); SKA_CMP_SWAP(3, 4);
+            break;
+        case 7:
+            SKA_CMP_SWAP(0, 6); SKA_CMP_SWAP(2, 3); SKA_CMP_SWAP(4, 5);
+            SKA_CMP_SWAP(0, 2); SKA_CMP_SWAP(1, 4); SKA_CMP_SWAP(3, 6);
+            SKA_CMP_SWAP(0, 1); SKA_CMP_SWAP(2, 5); SKA_CMP_SWAP(3, 4);
+            SKA_CMP_SWAP(1, 2); SKA_CMP_SWAP(4, 6);
+            SKA_CMP_SWAP(2, 3); SKA_CMP_SWAP(4, 5);
+            SKA_CMP_SWAP(1, 2); SKA_CMP_SWAP(3, 4); SKA_CMP_SWAP(5, 6);
+            break;
+        case 8:
+            SKA_CMP_SWAP(0, 2); SKA_CMP_SWAP(1, 3); SKA_CMP_SWAP(4, 6); SKA_CMP_SWAP(5, 7);
+            SKA_CMP_SWAP(0, 4); SKA_CMP_SWAP(1, 5); SKA_CMP_SWAP(2, 6); SKA_CMP_SWAP(3, 7);
+            SKA_CMP_SWAP(0, 1); SKA_CMP_SWAP(2, 3); SKA_CMP_SWAP(4, 5); SKA_CMP_SWAP(6, 7);
+            SKA_CMP_SWAP(2, 4); SKA_CMP_SWAP(3, 5);
+            SKA_CMP_SWAP(1, 4); SKA_CMP_SWAP(3, 6);
+            SKA_CMP_SWAP(1, 2); SKA_CMP_SWAP(3, 4); SKA_CMP_SWAP(5, 6);
+            break;
+        default:
+            InsertionSmallSorter::sort(begin, end, extract_key);
+            break;
+        }
+        #undef SKA_CMP_SWAP
+    }
+};
+
+template<std::ptrdiff_t StdSortThreshold_, std::ptrdiff_t AmericanFlagSortThreshold_, typename SmallSorter, typename CountType = size_t>
+struct SortPolicy
+{
+    static constexpr std::ptrdiff_t StdSortThreshold = StdSortThreshold_;
+    static constexpr std::ptrdiff_t AmericanFlagSortThreshold = AmericanFlagSortThreshold_;
+
+    typedef CountType count_type;
+
+    template<typename It, typename ExtractKey>
+    static void small_sort(It begin, It end, ExtractKey & extract_key)
+    {
+        SmallSorter::sort(begin, end, extract_key);
+    }
+};
+
+template<typename Policy>
+struct WideCountPolicy : Policy
+{
+    typedef size_t count_type;
+};
+
+} // namespace ska_detail
+
+namespace ska_policy
+{
+
+typedef ska_detail::DefaultSortPolicy                                                   Default;
+typedef ska_detail::SortPolicy<128,  1024, ska_detail::PdqsortSmallSorter,   uint32_t> Pdqsort;
+typedef ska_detail::SortPolicy<48,   1024, ska_detail::InsertionSmallSorter, uint32_t> Insertion;
+typedef ska_detail::SortPolicy<16,   1024, ska_detail::NetworkSmallSorter,   uint32_t> Network;
+typedef ska_detail::SortPolicy<128,  1024, ska_detail::QuadSmallSorter,      uint32_t> Quad;
+typedef ska_detail::SortPolicy<64,   8192, ska_detail::PdqsortSmallSorter,   uint32_t> L1;
+typedef ska_detail::SortPolicy<128, 65536, ska_detail::PdqsortSmallSorter,   uint32_t> L2;
+
+} // namespace ska_policy
+
+template<typename Policy, typename It, typename ExtractKey>
+void ska_sort_tuned(It begin, It end, ExtractKey && extract_key)
+{
+    typedef typename Policy::count_type count_type;
+    if (static_cast<unsigned long long>(end - begin) <= static_cast<unsigned long long>(std::numeric_limits<count_type>::max()))
+        ska_detail::inplace_radix_sort<Policy>(begin, end, extract_key);
+    else
+        ska_detail::inplace_radix_sort<ska_detail::WideCountPolicy<Policy>>(begin, end, extract_key);
+}
+
+template<typename Policy, typename It>
+void ska_sort_tuned(It begin, It end)
+{
+    ska_sort_tuned<Policy>(begin, end, ska_detail::IdentityFunctor());
+}
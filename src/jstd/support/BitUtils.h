@@ -12,6 +12,7 @@
 #include <assert.h>
 
 #include "jstd/basic/stddef.h"
+#include "jstd/support/CPUFeatures.h"
 
 #if (defined(_MSC_VER) && (_MSC_VER >= 1500)) && !defined(__clang__)
 #include <intrin.h>
@@ -504,6 +505,312 @@ namespace BitUtils {
 #pragma warning (pop)
 #endif
 
+    //
+    // The bitmap scan, see for_each_set_bit().
+    //
+    namespace scan_detail {
+
+    // The bits of a word
+    static const size_t kWordBits = sizeof(size_t) * 8;
+
+    // The words of a scan block, the zero blocks are skipped by one test
+    static const size_t kBlockWords = 512 / kWordBits;
+
+    // The bits of a scan block
+    static const size_t kBlockBits = kBlockWords * kWordBits;
+
+    // The slack of the index buffer, the decoders write 32 (or 8) offsets at a time
+    static const size_t kIndexSlack = 32;
+
+    typedef size_t (*DecodeBlockFunc)(const size_t * words, size_t count, uint16_t * indices);
+
+    // The positions of the set bits of each byte, and the number of them.
+    struct ByteBitTable {
+        uint8_t index[256][8];
+        uint8_t count[256];
+
+        ByteBitTable() {
+            for (size_t b = 0; b < 256; b++) {
+                uint8_t n = 0;
+                for (uint8_t bit = 0; bit < 8; bit++) {
+                    if ((b & (size_t(1) << bit)) != 0)
+                        index[b][n++] = bit;
+                }
+                count[b] = n;
+                for (; n < 8; n++) {
+                    index[b][n] = 0;
+                }
+            }
+        }
+    };
+
+    static inline const ByteBitTable & byte_bit_table() {
+        static const ByteBitTable table;
+        return table;
+    }
+
+    //
+    // Decode the set bits of words[0, count) to the offsets from words[0], ascending,
+    // a byte at a time by the table. Returns the number of the offsets.
+    //
+    static inline size_t decode_block_lut(const size_t * words, size_t count, uint16_t * indices) {
+        const ByteBitTable & table = byte_bit_table();
+        uint16_t * out = indices;
+        for (size_t w = 0; w < count; w++) {
+            size_t word = words[w];
+            uint16_t base = static_cast<uint16_t>(w * kWordBits);
+            while (word != 0) {
+                size_t byte = word & 0xFFu;
+                const uint8_t * index = table.index[byte];
+                for (size_t i = 0; i < 8; i++) {
+                    out[i] = static_cast<uint16_t>(base + index[i]);
+                }
+                out += table.count[byte];
+                word >>= 8;
+                base += 8;
+            }
+        }
+        return static_cast<size_t>(out - indices);
+    }
+
+#if JSTD_HAS_TARGET_AVX512VBMI2 && (JSTD_WORD_LEN == 64)
+    //
+    // Decode a half word at a time: the 16-bit positions [0, 32) are compressed by
+    // the 32 bits (VBMI2), 32 offsets are always written.
+    //
+    JSTD_TARGET_AVX512VBMI2
+    static inline size_t decode_block_avx512vbmi2(const size_t * words, size_t count,
+                                                  uint16_t * indices) {
+        const __m512i positions = _mm512_set_epi16(
+            31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16,
+            15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  0);
+        const __m512i half = _mm512_set1_epi16(32);
+        uint16_t * out = indices;
+        __m512i base = positions;
+        for (size_t w = 0; w < count; w++) {
+            uint64_t word = static_cast<uint64_t>(words[w]);
+            if (word != 0) {
+                __mmask32 low  = static_cast<__mmask32>(word);
+                __mmask32 high = static_cast<__mmask32>(word >> 32);
+                _mm512_storeu_si512(reinterpret_cast<void *>(out),
+                                    _mm512_maskz_compress_epi16(low, base));
+                out += _mm_popcnt_u32(static_cast<unsigned int>(low));
+                _mm512_storeu_si512(reinterpret_cast<void *>(out),
+                                    _mm512_maskz_compress_epi16(high, _mm512_add_epi16(base, half)));
+                out += _mm_popcnt_u32(static_cast<unsigned int>(high));
+            }
+            base = _mm512_add_epi16(base, _mm512_add_epi16(half, half));
+        }
+        return static_cast<size_t>(out - indices);
+    }
+#endif
+
+    //
+    // The decoder of the CPU, resolved once.
+    //
+    static inline DecodeBlockFunc get_block_decoder() {
+        struct Resolver {
+            static DecodeBlockFunc resolve() {
+#if JSTD_HAS_TARGET_AVX512VBMI2 && (JSTD_WORD_LEN == 64)
+                const CPUFeatures & features = CPUFeatures::get();
+                if (features.avx512vbmi2 && features.avx512bw && features.popcnt)
+                    return &decode_block_avx512vbmi2;
+#endif
+                return &decode_block_lut;
+            }
+        };
+        static const DecodeBlockFunc decoder = Resolver::resolve();
+        return decoder;
+    }
+
+    static inline bool is_zero_block(const size_t * words, size_t count) {
+        size_t bits = 0;
+        for (size_t i = 0; i < count; i++) {
+            bits |= words[i];
+        }
+        return (bits == 0);
+    }
+
+    //
+    // Find the blocks which have a set bit in the full blocks [first, last):
+    // find_first() returns the first one, or last; find_last() returns the end of
+    // the last one (the blocks [end, last) are zero), or first.
+    // A call skips a run of the zero blocks, the kernel is called through a pointer.
+    //
+    typedef size_t (*FindBlockFunc)(const size_t * words, size_t first, size_t last);
+
+    static inline size_t find_first_block_scalar(const size_t * words, size_t first, size_t last) {
+        while (first < last && is_zero_block(words + first * kBlockWords, kBlockWords)) {
+            first++;
+        }
+        return first;
+    }
+
+    static inline size_t find_last_block_scalar(const size_t * words, size_t first, size_t last) {
+        while (last > first && is_zero_block(words + (last - 1) * kBlockWords, kBlockWords)) {
+            last--;
+        }
+        return last;
+    }
+
+#if JSTD_HAS_TARGET_AVX2
+    // A block is 64 bytes, two AVX2 registers.
+    JSTD_TARGET_AVX2
+    static inline bool is_zero_block_avx2(const size_t * words) {
+        __m256i bits0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words));
+        __m256i bits1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words) + 1);
+        __m256i bits  = _mm256_or_si256(bits0, bits1);
+        return (_mm256_testz_si256(bits, bits) != 0);
+    }
+
+    JSTD_TARGET_AVX2
+    static inline size_t find_first_block_avx2(const size_t * words, size_t first, size_t last) {
+        while (first < last && is_zero_block_avx2(words + first * kBlockWords)) {
+            first++;
+        }
+        return first;
+    }
+
+    JSTD_TARGET_AVX2
+    static inline size_t find_last_block_avx2(const size_t * words, size_t first, size_t last) {
+        while (last > first && is_zero_block_avx2(words + (last - 1) * kBlockWords)) {
+            last--;
+        }
+        return last;
+    }
+#endif
+
+#if JSTD_HAS_TARGET_AVX512
+    // A block is 64 bytes, one AVX-512 register.
+    JSTD_TARGET_AVX512
+    static inline bool is_zero_block_avx512(const size_t * words) {
+        __m512i bits = _mm512_loadu_si512(reinterpret_cast<const void *>(words));
+        return (_mm512_test_epi32_mask(bits, bits) == 0);
+    }
+
+    JSTD_TARGET_AVX512
+    static inline size_t find_first_block_avx512(const size_t * words, size_t first, size_t last) {
+        while (first < last && is_zero_block_avx512(words + first * kBlockWords)) {
+            first++;
+        }
+        return first;
+    }
+
+    JSTD_TARGET_AVX512
+    static inline size_t find_last_block_avx512(const size_t * words, size_t first, size_t last) {
+        while (last > first && is_zero_block_avx512(words + (last - 1) * kBlockWords)) {
+            last--;
+        }
+        return last;
+    }
+#endif
+
+    struct BlockFinder {
+        FindBlockFunc   find_first;
+        FindBlockFunc   find_last;
+        const char *    name;
+    };
+
+    //
+    // The block finder of the CPU, resolved once.
+    //
+    static inline const BlockFinder & get_block_finder() {
+        struct Resolver {
+            static BlockFinder resolve() {
+                const CPUFeatures & cpu = CPUFeatures::get();
+                (void)cpu;
+#if JSTD_HAS_TARGET_AVX512
+                if (cpu.avx512f) {
+                    BlockFinder avx512 = { &find_first_block_avx512, &find_last_block_avx512, "AVX-512" };
+                    return avx512;
+                }
+#endif
+#if JSTD_HAS_TARGET_AVX2
+                if (cpu.avx2) {
+                    BlockFinder avx2 = { &find_first_block_avx2, &find_last_block_avx2, "AVX2" };
+                    return avx2;
+                }
+#endif
+                BlockFinder scalar = { &find_first_block_scalar, &find_last_block_scalar, "scalar" };
+                return scalar;
+            }
+        };
+        static const BlockFinder finder = Resolver::resolve();
+        return finder;
+    }
+
+    } // namespace scan_detail
+
+    static inline const char * bitmap_decoder_name() {
+#if JSTD_HAS_TARGET_AVX512VBMI2 && (JSTD_WORD_LEN == 64)
+        if (scan_detail::get_block_decoder() == &scan_detail::decode_block_avx512vbmi2)
+            return "avx512vbmi2";
+#endif
+        return "lut";
+    }
+
+    //
+    // Call func(index) for each set bit of the bitmap words[0, word_count), from the lowest
+    // index. The bitmap is scanned by the blocks of 512 bits: the runs of the zero blocks are
+    // skipped by one test per block (AVX-512, AVX2 or scalar, picked by CPUFeatures at run time),
+    // the set bits of the other blocks are decoded to a buffer of indices
+    // (the AVX-512 VBMI2 compress, or a table of the 256 bytes), then func is called on them.
+    //
+    template <typename Func>
+    static inline void for_each_set_bit(const size_t * words, size_t word_count, Func && func) {
+        uint16_t indices[scan_detail::kBlockBits + scan_detail::kIndexSlack];
+        scan_detail::DecodeBlockFunc decode = scan_detail::get_block_decoder();
+        scan_detail::FindBlockFunc find_first = scan_detail::get_block_finder().find_first;
+        size_t full_blocks = word_count / scan_detail::kBlockWords;
+        size_t block_count = (word_count + scan_detail::kBlockWords - 1) / scan_detail::kBlockWords;
+        for (size_t n = 0; n < block_count; n++) {
+            if (n < full_blocks) {
+                n = find_first(words, n, full_blocks);
+                if (n == full_blocks && n == block_count)
+                    break;
+            }
+            size_t block = n * scan_detail::kBlockWords;
+            size_t count = word_count - block;
+            count = (count < scan_detail::kBlockWords) ? count : scan_detail::kBlockWords;
+            if (count != scan_detail::kBlockWords && scan_detail::is_zero_block(words + block, count))
+                continue;
+            size_t base = block * scan_detail::kWordBits;
+            size_t total = decode(words + block, count, indices);
+            for (size_t i = 0; i < total; i++) {
+                func(base + indices[i]);
+            }
+        }
+    }
+
+    //
+    // Call func(index) for each set bit of the bitmap, from the highest index.
+    //
+    template <typename Func>
+    static inline void for_each_set_bit_reverse(const size_t * words, size_t word_count, Func && func) {
+        uint16_t indices[scan_detail::kBlockBits + scan_detail::kIndexSlack];
+        scan_detail::DecodeBlockFunc decode = scan_detail::get_block_decoder();
+        scan_detail::FindBlockFunc find_last = scan_detail::get_block_finder().find_last;
+        size_t full_blocks = word_count / scan_detail::kBlockWords;
+        size_t block_count = (word_count + scan_detail::kBlockWords - 1) / scan_detail::kBlockWords;
+        for (size_t n = block_count; n > 0; n--) {
+            if (n <= full_blocks) {
+                n = find_last(words, 0, n);
+                if (n == 0)
+                    break;
+            }
+            size_t block = (n - 1) * scan_detail::kBlockWords;
+            size_t count = word_count - block;
+            count = (count < scan_detail::kBlockWords) ? count : scan_detail::kBlockWords;
+            if (count != scan_detail::kBlockWords && scan_detail::is_zero_block(words + block, count))
+                continue;
+            size_t base = block * scan_detail::kWordBits;
+            size_t total = decode(words + block, count, indices);
+            for (size_t i = total; i > 0; i--) {
+                func(base + indices[i - 1]);
+            }
+        }
+    }
+
 } // namespace BitUtils
 } // namespace jstd
 
@@ -0,0 +1,179 @@
+
+#ifndef JSTD_SUPPORT_CPU_FEATURES_H
+#define JSTD_SUPPORT_CPU_FEATURES_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__amd64__) || defined(__x86_64__) \
+ || defined(_M_IX86) || defined(__i386__)
+#define JSTD_CPU_FEATURES_X86       1
+#else
+#define JSTD_CPU_FEATURES_X86       0
+#endif
+
+//
+// The SIMD kernels of the other ISA than the compile flags: the functions with
+// JSTD_TARGET_AVX2 / JSTD_TARGET_AVX512 may use the intrinsics of that ISA, and
+// are called through a function pointer only if jstd::CPUFeatures has the ISA.
+//
+// JSTD_HAS_TARGET_AVX2 / JSTD_HAS_TARGET_AVX512 / JSTD_HAS_TARGET_AVX512VBMI2:
+// the compiler supports them. JSTD_TARGET_AVX512VBMI2 also has AVX512BW and POPCNT.
+//
+#if JSTD_CPU_FEATURES_X86 && (defined(__GNUC__) || defined(__clang__))
+  #include <cpuid.h>
+  #include <immintrin.h>
+
+  #define JSTD_TARGET_AVX2          __attribute__((target("avx2")))
+  #define JSTD_TARGET_AVX512        __attribute__((target("avx2,avx512f")))
+  #define JSTD_TARGET_AVX512VBMI2   __attribute__((target("popcnt,avx2,avx512f,avx512bw,avx512vbmi2")))
+
+  #define JSTD_HAS_TARGET_AVX2      1
+  #define JSTD_HAS_TARGET_AVX512    1
+  #define JSTD_HAS_TARGET_AVX512VBMI2   1
+#elif JSTD_CPU_FEATURES_X86 && defined(_MSC_VER)
+  #include <intrin.h>
+  #include <immintrin.h>
+
+  // MSVC allows the intrinsics of any ISA without the /arch flags.
+  #define JSTD_TARGET_AVX2
+  #define JSTD_TARGET_AVX512
+  #define JSTD_TARGET_AVX512VBMI2
+
+  #define JSTD_HAS_TARGET_AVX2      1
+  #if (_MSC_VER >= 1910)
+  #define JSTD_HAS_TARGET_AVX512    1
+  #else
+  #define JSTD_HAS_TARGET_AVX512    0
+  #endif
+  #if (_MSC_VER >= 1920)
+  #define JSTD_HAS_TARGET_AVX512VBMI2   1
+  #else
+  #define JSTD_HAS_TARGET_AVX512VBMI2   0
+  #endif
+#else
+  #define JSTD_TARGET_AVX2
+  #define JSTD_TARGET_AVX512
+  #define JSTD_TARGET_AVX512VBMI2
+
+  #define JSTD_HAS_TARGET_AVX2      0
+  #define JSTD_HAS_TARGET_AVX512    0
+  #define JSTD_HAS_TARGET_AVX512VBMI2   0
+#endif
+
+namespace jstd {
+
+//
+// The features of the CPU which runs the program (CPUID), detected once.
+//
+// The AVX and AVX-512 features are set only if the OS saves the YMM and ZMM states (XGETBV).
+//
+struct CPUFeatures {
+    bool sse42;
+    bool popcnt;
+    bool bmi2;
+    bool avx2;
+    bool avx512f;
+    bool avx512bw;
+    bool avx512vl;
+    bool avx512vbmi2;
+
+    static const CPUFeatures & get() {
+        static const CPUFeatures features = detect();
+        return features;
+    }
+
+    std::string to_string() const {
+        std::string features;
+        if (sse42)       features += "sse4.2 ";
+        if (popcnt)      features += "popcnt ";
+        if (bmi2)        features += "bmi2 ";
+        if (avx2)        features += "avx2 ";
+        if (avx512f)     features += "avx512f ";
+        if (avx512bw)    features += "avx512bw ";
+        if (avx512vl)    features += "avx512vl ";
+        if (avx512vbmi2) features += "avx512vbmi2 ";
+        if (!features.empty())
+            features.pop_back();
+        else
+            features = "none";
+        return features;
+    }
+
+#if JSTD_CPU_FEATURES_X86
+    // CPUID of a leaf and a subleaf, regs[] = { eax, ebx, ecx, edx }.
+    static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+        for (size_t i = 0; i < 4; i++) {
+            regs[i] = static_cast<uint32_t>(info[i]);
+        }
+#else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+#endif // JSTD_CPU_FEATURES_X86
+
+private:
+    static CPUFeatures detect() {
+        CPUFeatures features = { };
+#if JSTD_CPU_FEATURES_X86
+        uint32_t regs[4];
+        cpuid(0, 0, regs);
+        uint32_t max_leaf = regs[0];
+        if (max_leaf < 1)
+            return features;
+
+        cpuid(1, 0, regs);
+        uint32_t ecx1 = regs[2];
+        features.sse42  = ((ecx1 & (1u << 20)) != 0);
+        features.popcnt = ((ecx1 & (1u << 23)) != 0);
+
+        bool os_avx = false, os_avx512 = false;
+        if ((ecx1 & (1u << 27)) != 0 && (ecx1 & (1u << 28)) != 0) {
+            // OSXSAVE and AVX: XCR0 has the XMM and YMM states (bits 1, 2),
+            // and the opmask, ZMM_Hi256, Hi16_ZMM states (bits 5, 6, 7).
+            uint64_t xcr0 = xgetbv0();
+            os_avx = ((xcr0 & 0x06) == 0x06);
+            os_avx512 = os_avx && ((xcr0 & 0xE0) == 0xE0);
+        }
+
+        if (max_leaf >= 7) {
+            cpuid(7, 0, regs);
+            uint32_t ebx7 = regs[1];
+            uint32_t ecx7 = regs[2];
+            features.bmi2        = ((ebx7 & (1u << 8)) != 0);
+            features.avx2        = os_avx && ((ebx7 & (1u << 5)) != 0);
+            features.avx512f     = os_avx512 && ((ebx7 & (1u << 16)) != 0);
+            features.avx512bw    = features.avx512f && ((ebx7 & (1u << 30)) != 0);
+            features.avx512vl    = features.avx512f && ((ebx7 & (1u << 31)) != 0);
+            features.avx512vbmi2 = features.avx512f && ((ecx7 & (1u << 6)) != 0);
+        }
+#endif // JSTD_CPU_FEATURES_X86
+        return features;
+    }
+
+#if JSTD_CPU_FEATURES_X86
+    static uint64_t xgetbv0() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return static_cast<uint64_t>(_xgetbv(0));
+#else
+        uint32_t eax, edx;
+        __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return ((static_cast<uint64_t>(edx) << 32) | eax);
+#endif
+    }
+#endif // JSTD_CPU_FEATURES_X86
+};
+
+} // namespace jstd
+
+#endif // !JSTD_SUPPORT_CPU_FEATURES_H
@@ -0,0 +1,223 @@
+
+#ifndef JSTD_SUPPORT_CACHE_INFO_H
+#define JSTD_SUPPORT_CACHE_INFO_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+#include "jstd/support/CPUFeatures.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace jstd {
+
+//
+// The data caches and the data TLB of the CPU which runs the program, detected once.
+//
+// x86: CPUID leaf 4 (Intel) or leaf 0x8000001D (AMD) for the caches, CPUID leaf 0x18 (Intel)
+// or leaf 0x80000005 (AMD) for the first level data TLB. The other CPUs on Linux read
+// /sys/devices/system/cpu/cpu0/cache. The sizes which can't be detected keep the defaults.
+//
+struct CacheInfo {
+    // The defaults, a common desktop CPU.
+    static const size_t kDefaultLineSize    = 64;
+    static const size_t kDefaultL1DSize     = 32 * 1024;
+    static const size_t kDefaultL2Size      = 256 * 1024;
+    static const size_t kDefaultL3Size      = 8 * 1024 * 1024;
+    static const size_t kDefaultDTLBEntries = 64;
+    static const size_t kPageSize           = 4096;
+
+    size_t line_size;
+    size_t l1d_size;
+    size_t l2_size;
+    size_t l3_size;
+    size_t dtlb_entries;
+
+    static const CacheInfo & get() {
+        static const CacheInfo info = detect();
+        return info;
+    }
+
+    // The memory the first level data TLB maps with the 4K pages.
+    size_t tlb_reach() const {
+        return (dtlb_entries * kPageSize);
+    }
+
+    std::string to_string() const {
+        char buf[256];
+        std::snprintf(buf, sizeof(buf),
+                      "line = %u, L1d = %uK, L2 = %uK, L3 = %uK, dTLB = %u entries",
+                      (uint32_t)line_size, (uint32_t)(l1d_size / 1024),
+                      (uint32_t)(l2_size / 1024), (uint32_t)(l3_size / 1024),
+                      (uint32_t)dtlb_entries);
+        return std::string(buf);
+    }
+
+private:
+    static CacheInfo detect() {
+        CacheInfo info;
+        info.line_size    = kDefaultLineSize;
+        info.l1d_size     = kDefaultL1DSize;
+        info.l2_size      = kDefaultL2Size;
+        info.l3_size      = kDefaultL3Size;
+        info.dtlb_entries = kDefaultDTLBEntries;
+
+        bool detected = false;
+#if JSTD_CPU_FEATURES_X86
+        detected = detect_cpuid(info);
+#endif
+#if defined(__linux__)
+        if (!detected)
+            detected = detect_sysfs(info);
+#endif
+        (void)detected;
+        return info;
+    }
+
+    void set_cache(size_t level, size_t size, size_t line) {
+        if (size == 0)
+            return;
+        if (level == 1)
+            l1d_size = size;
+        else if (level == 2)
+            l2_size = size;
+        else if (level == 3)
+            l3_size = size;
+        if (level == 1 && line != 0)
+            line_size = line;
+    }
+
+#if JSTD_CPU_FEATURES_X86
+    // The leaf 4 and the leaf 0x8000001D have the same layout.
+    bool detect_cache_leaf(uint32_t leaf) {
+        bool found = false;
+        for (uint32_t subleaf = 0; subleaf < 16; subleaf++) {
+            uint32_t regs[4];
+            CPUFeatures::cpuid(leaf, subleaf, regs);
+            uint32_t type = regs[0] & 0x1Fu;
+            if (type == 0)
+                break;
+            // 1: data cache, 3: unified cache
+            if (type != 1 && type != 3)
+                continue;
+            size_t level      = (regs[0] >> 5) & 0x07u;
+            size_t line       = (regs[1] & 0x0FFFu) + 1;
+            size_t partitions = ((regs[1] >> 12) & 0x03FFu) + 1;
+            size_t ways       = ((regs[1] >> 22) & 0x03FFu) + 1;
+            size_t sets       = static_cast<size_t>(regs[2]) + 1;
+            set_cache(level, ways * partitions * line * sets, line);
+            found = true;
+        }
+        return found;
+    }
+
+    static bool detect_cpuid(CacheInfo & info) {
+        uint32_t regs[4];
+        CPUFeatures::cpuid(0, 0, regs);
+        uint32_t max_leaf = regs[0];
+        // "GenuineIntel" or "AuthenticAMD" / "HygonGenuine"
+        bool intel = (regs[1] == 0x756E6547u);
+        CPUFeatures::cpuid(0x80000000u, 0, regs);
+        uint32_t max_ext_leaf = regs[0];
+
+        bool found = false;
+        if (intel && max_leaf >= 4) {
+            found = info.detect_cache_leaf(4);
+        } else if (!intel && max_ext_leaf >= 0x8000001Du) {
+            found = info.detect_cache_leaf(0x8000001Du);
+        }
+
+        if (intel && max_leaf >= 0x18) {
+            CPUFeatures::cpuid(0x18, 0, regs);
+            uint32_t max_subleaf = regs[0];
+            for (uint32_t subleaf = 0; subleaf <= max_subleaf && subleaf < 16; subleaf++) {
+                CPUFeatures::cpuid(0x18, subleaf, regs);
+                uint32_t type  = regs[3] & 0x1Fu;
+                uint32_t level = (regs[3] >> 5) & 0x07u;
+                bool page_4k   = ((regs[1] & 0x01u) != 0);
+                // 1: data TLB, 3: unified TLB, 4: load only TLB
+                if ((type == 1 || type == 3 || type == 4) && level == 1 && page_4k) {
+                    size_t entries = static_cast<size_t>(regs[1] >> 16) * regs[2];
+                    if (entries != 0) {
+                        info.dtlb_entries = entries;
+                        break;
+                    }
+                }
+            }
+        } else if (!intel && max_ext_leaf >= 0x80000005u) {
+            CPUFeatures::cpuid(0x80000005u, 0, regs);
+            size_t entries = (regs[1] >> 16) & 0xFFu;
+            if (entries != 0)
+                info.dtlb_entries = entries;
+        }
+        return found;
+    }
+#endif // JSTD_CPU_FEATURES_X86
+
+#if defined(__linux__)
+    static bool read_sysfs(const char * path, char * buf, size_t size) {
+        std::FILE * fp = std::fopen(path, "r");
+        if (fp == nullptr)
+            return false;
+        bool ok = (std::fgets(buf, static_cast<int>(size), fp) != nullptr);
+        std::fclose(fp);
+        return ok;
+    }
+
+    // "48K", "2048K", "105M"
+    static size_t parse_size(const char * text) {
+        size_t size = 0;
+        while (*text >= '0' && *text <= '9') {
+            size = size * 10 + static_cast<size_t>(*text - '0');
+            text++;
+        }
+        if (*text == 'K' || *text == 'k')
+            size *= 1024;
+        else if (*text == 'M' || *text == 'm')
+            size *= 1024 * 1024;
+        return size;
+    }
+
+    static bool detect_sysfs(CacheInfo & info) {
+        bool found = false;
+        for (size_t index = 0; index < 16; index++) {
+            char path[128], buf[64];
+            std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/type",
+                          (uint32_t)index);
+            if (!read_sysfs(path, buf, sizeof(buf)))
+                break;
+            if (std::strncmp(buf, "Data", 4) != 0 && std::strncmp(buf, "Unified", 7) != 0)
+                continue;
+            std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/level",
+                          (uint32_t)index);
+            if (!read_sysfs(path, buf, sizeof(buf)))
+                continue;
+            size_t level = parse_size(buf);
+            std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/size",
+                          (uint32_t)index);
+            if (!read_sysfs(path, buf, sizeof(buf)))
+                continue;
+            size_t size = parse_size(buf);
+            size_t line = 0;
+            std::snprintf(path, sizeof(path),
+                          "/sys/devices/system/cpu/cpu0/cache/index%u/coherency_line_size",
+                          (uint32_t)index);
+            if (read_sysfs(path, buf, sizeof(buf)))
+                line = parse_size(buf);
+            info.set_cache(level, size, line);
+            found = true;
+        }
+        return found;
+    }
+#endif // __linux__
+};
+
+} // namespace jstd
+
+#endif // !JSTD_SUPPORT_CACHE_INFO_H
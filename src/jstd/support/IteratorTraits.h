@@ -0,0 +1,26 @@
+
+#ifndef JSTD_SUPPORT_ITERATOR_TRAITS_H
+#define JSTD_SUPPORT_ITERATOR_TRAITS_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <vector>
+#include <type_traits>
+
+namespace jstd {
+
+//
+// The iterators of the values stored contiguously: a pointer, or a std::vector<T> iterator.
+// The kernels on the raw memory (memmove(), memcpy(), SIMD) take &*first for them.
+//
+template <typename Iter, typename T>
+struct is_contiguous_iterator : std::integral_constant<bool,
+    std::is_pointer<Iter>::value ||
+    std::is_same<Iter, typename std::vector<T>::iterator>::value ||
+    std::is_same<Iter, typename std::vector<T>::const_iterator>::value> {};
+
+} // namespace jstd
+
+#endif // !JSTD_SUPPORT_ITERATOR_TRAITS_H
@@ -0,0 +1,146 @@
+
+#ifndef JSTD_SUPPORT_LOSER_TREE_H
+#define JSTD_SUPPORT_LOSER_TREE_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+
+#include <assert.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <functional>   // For std::less<T>
+#include <utility>
+
+namespace jstd {
+
+//
+// A tournament tree of losers for the k-way merge.
+//
+// Every internal node keeps the head (value and source) that lost the match at this node,
+// and node 0 keeps the overall winner, so replacing the head of the winner only replays
+// the matches on the path from its leaf to the root: log2(k) matches, one per level,
+// rather than the 2 * log2(k) compares of a binary heap.
+//
+// The ties are won by the source with the smaller index, so merging the runs
+// in their order is stable. An exhausted source loses every match.
+//
+template <typename T, typename Compare = std::less<T>>
+class LoserTree {
+public:
+    typedef T       value_type;
+    typedef Compare compare_type;
+
+private:
+    // The head of a source, the nodes keep it by value, the matches don't chase the sources.
+    struct Node {
+        T      value;
+        size_t source;
+        bool   exhausted;
+    };
+
+    std::vector<Node> nodes_;
+    size_t            sources_;
+    size_t            remain_;
+    Compare           comp_;
+
+public:
+    explicit LoserTree(size_t sources, Compare comp = Compare())
+        : nodes_(sources * 2), sources_(sources), remain_(0), comp_(comp) {
+        assert(sources > 0);
+        for (size_t i = 0; i < sources; i++) {
+            Node & leaf = nodes_[sources + i];
+            leaf.value = T();
+            leaf.source = i;
+            leaf.exhausted = true;
+        }
+    }
+
+    ~LoserTree() {}
+
+    size_t sources() const { return sources_; }
+    size_t remain() const { return remain_; }
+    bool empty() const { return (remain_ == 0); }
+
+    // Set the head of each source before build(), the sources without head are exhausted.
+    void set_head(size_t source, const T & value) {
+        assert(source < sources_);
+        Node & leaf = nodes_[sources_ + source];
+        leaf.value = value;
+        if (leaf.exhausted) {
+            leaf.exhausted = false;
+            remain_++;
+        }
+    }
+
+    //
+    // The leaves are nodes_[sources_, sources_ * 2), the parent of node i is i / 2,
+    // nodes_[1, sources_) keep the losers, nodes_[0] keeps the winner.
+    //
+    void build() {
+        std::vector<Node> winners(nodes_.begin(), nodes_.end());
+        for (size_t node = sources_ - 1; node > 0; node--) {
+            const Node & left  = winners[node * 2];
+            const Node & right = winners[node * 2 + 1];
+            if (less(left, right)) {
+                winners[node] = left;
+                nodes_[node] = right;
+            } else {
+                winners[node] = right;
+                nodes_[node] = left;
+            }
+        }
+        nodes_[0] = (sources_ > 1) ? winners[1] : winners[sources_];
+    }
+
+    // The source of the smallest head.
+    size_t top() const {
+        assert(!empty());
+        return nodes_[0].source;
+    }
+
+    const T & top_value() const {
+        assert(!empty());
+        return nodes_[0].value;
+    }
+
+    // The winner has the next value.
+    void replace_top(const T & value) {
+        Node winner = nodes_[0];
+        winner.value = value;
+        replay(winner);
+    }
+
+    // The winner is exhausted.
+    void pop_top() {
+        Node winner = nodes_[0];
+        assert(!winner.exhausted);
+        winner.exhausted = true;
+        remain_--;
+        replay(winner);
+    }
+
+private:
+    // a wins the match against b, branchless, both compares are always evaluated.
+    bool less(const Node & a, const Node & b) const {
+        bool lt = comp_(a.value, b.value);
+        bool gt = comp_(b.value, a.value);
+        return ((!a.exhausted) & (b.exhausted | lt | ((!gt) & (a.source < b.source))));
+    }
+
+    void replay(Node winner) {
+        for (size_t node = (winner.source + sources_) / 2; node > 0; node /= 2) {
+            if (less(nodes_[node], winner))
+                std::swap(nodes_[node], winner);
+        }
+        nodes_[0] = winner;
+    }
+};
+
+} // namespace jstd
+
+#endif // !JSTD_SUPPORT_LOSER_TREE_H
@@ -0,0 +1,255 @@
+
+#ifndef JSTD_SUPPORT_MAPPED_FILE_H
+#define JSTD_SUPPORT_MAPPED_FILE_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+
+#include <assert.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#if defined(_WIN32) || defined(_WIN64)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace jstd {
+
+//
+// A memory mapped file, the whole file is mapped.
+//
+// The madvise() hints are ignored where they are not supported (Windows).
+// There is no huge page hint: MADV_HUGEPAGE doesn't apply to the file mappings.
+//
+class MappedFile {
+public:
+    enum Access {
+        ReadOnly,
+        ReadWrite,
+        // The writes are private, the file is not changed.
+        CopyOnWrite
+    };
+
+    enum Advice {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed,
+        DontNeed
+    };
+
+private:
+    void * data_;
+    size_t size_;
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE file_;
+    HANDLE mapping_;
+#else
+    int    fd_;
+#endif
+
+public:
+    MappedFile() noexcept
+        : data_(nullptr), size_(0)
+#if defined(_WIN32) || defined(_WIN64)
+          , file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+#else
+          , fd_(-1)
+#endif
+    {
+    }
+
+    ~MappedFile() {
+        this->close();
+    }
+
+    bool is_open() const { return (data_ != nullptr); }
+
+    void * data() const { return data_; }
+    size_t size() const { return size_; }
+
+    static bool get_file_size(const std::string & path, uint64_t & size) {
+#if defined(_WIN32) || defined(_WIN64)
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        if (!::GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes))
+            return false;
+        size = (uint64_t(attributes.nFileSizeHigh) << 32) | uint64_t(attributes.nFileSizeLow);
+#else
+        struct stat st;
+        if (::stat(path.c_str(), &st) != 0)
+            return false;
+        size = static_cast<uint64_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    //
+    // Map the existing file, an empty file can't be mapped.
+    //
+    bool open(const std::string & path, Access access) {
+        this->close();
+#if defined(_WIN32) || defined(_WIN64)
+        DWORD file_access = (access == ReadWrite) ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ;
+        file_ = ::CreateFileA(path.c_str(), file_access, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER file_size;
+        if (!::GetFileSizeEx(file_, &file_size) || file_size.QuadPart == 0) {
+            this->close();
+            return false;
+        }
+        size_ = static_cast<size_t>(file_size.QuadPart);
+        return map_view(access);
+#else
+        fd_ = ::open(path.c_str(), (access == ReadWrite) ? O_RDWR : O_RDONLY);
+        if (fd_ < 0)
+            return false;
+        struct stat st;
+        if (::fstat(fd_, &st) != 0 || st.st_size == 0) {
+            this->close();
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        return map_view(access);
+#endif
+    }
+
+    //
+    // Create (or truncate) the file of size bytes and map it for read and write.
+    //
+    bool create(const std::string & path, size_t size) {
+        this->close();
+        if (size == 0)
+            return false;
+#if defined(_WIN32) || defined(_WIN64)
+        file_ = ::CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE)
+            return false;
+#else
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0)
+            return false;
+        if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+            this->close();
+            return false;
+        }
+#endif
+        size_ = size;
+        return map_view(ReadWrite);
+    }
+
+    void advise(Advice advice) {
+#if !defined(_WIN32) && !defined(_WIN64)
+        if (data_ == nullptr)
+            return;
+        int flag;
+        switch (advice) {
+        case Sequential:
+            flag = MADV_SEQUENTIAL;
+            break;
+        case Random:
+            flag = MADV_RANDOM;
+            break;
+        case WillNeed:
+            flag = MADV_WILLNEED;
+            break;
+        case DontNeed:
+            flag = MADV_DONTNEED;
+            break;
+        default:
+            flag = MADV_NORMAL;
+            break;
+        }
+        ::madvise(data_, size_, flag);
+#else
+        (void)advice;
+#endif
+    }
+
+    //
+    // Write the dirty pages to the file, and wait.
+    //
+    bool flush() {
+        if (data_ == nullptr)
+            return false;
+#if defined(_WIN32) || defined(_WIN64)
+        return (::FlushViewOfFile(data_, 0) != FALSE) && (::FlushFileBuffers(file_) != FALSE);
+#else
+        return (::msync(data_, size_, MS_SYNC) == 0);
+#endif
+    }
+
+    bool close() {
+        bool success = true;
+#if defined(_WIN32) || defined(_WIN64)
+        if (data_ != nullptr) {
+            success = (::UnmapViewOfFile(data_) != FALSE);
+            data_ = nullptr;
+        }
+        if (mapping_ != nullptr) {
+            ::CloseHandle(mapping_);
+            mapping_ = nullptr;
+        }
+        if (file_ != INVALID_HANDLE_VALUE) {
+            success = (::CloseHandle(file_) != FALSE) && success;
+            file_ = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (data_ != nullptr) {
+            success = (::munmap(data_, size_) == 0);
+            data_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            success = (::close(fd_) == 0) && success;
+            fd_ = -1;
+        }
+#endif
+        size_ = 0;
+        return success;
+    }
+
+private:
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator = (const MappedFile &) = delete;
+
+    bool map_view(Access access) {
+#if defined(_WIN32) || defined(_WIN64)
+        DWORD protect = (access == ReadWrite) ? PAGE_READWRITE :
+                        (access == CopyOnWrite) ? PAGE_WRITECOPY : PAGE_READONLY;
+        DWORD view_access = (access == ReadWrite) ? FILE_MAP_WRITE :
+                            (access == CopyOnWrite) ? FILE_MAP_COPY : FILE_MAP_READ;
+        mapping_ = ::CreateFileMappingA(file_, nullptr, protect, 0, 0, nullptr);
+        if (mapping_ != nullptr)
+            data_ = ::MapViewOfFile(mapping_, view_access, 0, 0, 0);
+#else
+        int protect = (access == ReadOnly) ? PROT_READ : (PROT_READ | PROT_WRITE);
+        int flags = (access == CopyOnWrite) ? MAP_PRIVATE : MAP_SHARED;
+        void * data = ::mmap(nullptr, size_, protect, flags, fd_, 0);
+        data_ = (data != MAP_FAILED) ? data : nullptr;
+#endif
+        if (data_ == nullptr) {
+            this->close();
+            return false;
+        }
+        return true;
+    }
+};
+
+} // namespace jstd
+
+#endif // !JSTD_SUPPORT_MAPPED_FILE_H
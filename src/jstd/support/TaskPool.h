@@ -0,0 +1,232 @@
+
+#ifndef JSTD_SUPPORT_TASK_POOL_H
+#define JSTD_SUPPORT_TASK_POOL_H
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "jstd/basic/stddef.h"
+
+#include <assert.h>
+
+#include <cstddef>
+#include <atomic>
+#include <deque>
+#include <memory>       // For std::unique_ptr<T>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <utility>
+
+namespace jstd {
+
+//
+// A counter of the outstanding tasks submitted to a TaskPool,
+// TaskPool::wait(group) returns when all of them are finished.
+//
+class TaskGroup {
+public:
+    TaskGroup() noexcept : pending_(0) {}
+    ~TaskGroup() {
+        assert(pending_.load() == 0);
+    }
+
+    bool is_done() const {
+        return (pending_.load(std::memory_order_acquire) == 0);
+    }
+
+private:
+    friend class TaskPool;
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup & operator = (const TaskGroup &) = delete;
+
+    std::atomic<size_t> pending_;
+};
+
+//
+// A fixed size work-stealing thread pool.
+//
+// thread_count is the total parallelism, including the thread who calls wait(),
+// so TaskPool(1) has no worker thread and runs every task inside wait().
+//
+// Every worker owns a task deque: it pushes and pops its own tasks at the back (LIFO,
+// the most recently split and cache-hot work first), and steals from the front of
+// the other deques (FIFO, the oldest and usually the biggest tasks) when its deque
+// is empty. Deque 0 receives the tasks submitted by the threads outside the pool.
+//
+// The waiting thread executes tasks while its group is not finished,
+// so tasks may submit and wait for nested tasks without deadlock.
+//
+class TaskPool {
+public:
+    typedef std::function<void()> task_type;
+
+private:
+    struct Task {
+        task_type   func;
+        TaskGroup * group;
+
+        Task() noexcept : group(nullptr) {}
+        Task(task_type && func, TaskGroup * group)
+            : func(std::move(func)), group(group) {}
+    };
+
+    struct WorkQueue {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    struct ThreadInfo {
+        const TaskPool * pool;
+        size_t           index;
+    };
+
+    std::vector<std::thread>     workers_;
+    std::unique_ptr<WorkQueue[]> queues_;
+    std::atomic<size_t>          queued_;
+    std::atomic<size_t>          sleepers_;
+    std::mutex                   sleep_mutex_;
+    std::condition_variable      sleep_cond_;
+    size_t                       thread_count_;
+    std::atomic<bool>            stop_;
+
+public:
+    explicit TaskPool(size_t thread_count = 0)
+        : queued_(0), sleepers_(0), thread_count_(thread_count), stop_(false) {
+        if (thread_count_ == 0)
+            thread_count_ = TaskPool::hardware_threads();
+        queues_.reset(new WorkQueue[thread_count_]);
+        for (size_t i = 1; i < thread_count_; i++) {
+            workers_.emplace_back([this, i]() { this->worker_loop(i); });
+        }
+    }
+
+    ~TaskPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_.store(true);
+        }
+        sleep_cond_.notify_all();
+        for (auto & worker : workers_) {
+            worker.join();
+        }
+    }
+
+    static size_t hardware_threads() {
+        size_t threads = static_cast<size_t>(std::thread::hardware_concurrency());
+        return (threads != 0) ? threads : 1;
+    }
+
+    size_t thread_count() const {
+        return thread_count_;
+    }
+
+    template <typename Func>
+    void submit(TaskGroup & group, Func && func) {
+        group.pending_.fetch_add(1, std::memory_order_relaxed);
+        WorkQueue & queue = queues_[current_index()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.emplace_back(task_type(std::forward<Func>(func)), &group);
+        }
+        queued_.fetch_add(1);
+        if (sleepers_.load() != 0) {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            sleep_cond_.notify_one();
+        }
+    }
+
+    void wait(TaskGroup & group) {
+        size_t index = current_index();
+        while (!group.is_done()) {
+            Task task;
+            if (try_pop(index, task) || try_steal(index, task))
+                run_task(task);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+private:
+    TaskPool(const TaskPool &) = delete;
+    TaskPool & operator = (const TaskPool &) = delete;
+
+    static ThreadInfo & thread_info() {
+        static thread_local ThreadInfo s_thread_info = { nullptr, 0 };
+        return s_thread_info;
+    }
+
+    size_t current_index() const {
+        const ThreadInfo & info = thread_info();
+        return (info.pool == this) ? info.index : 0;
+    }
+
+    static void run_task(Task & task) {
+        task.func();
+        task.group->pending_.fetch_sub(1, std::memory_order_release);
+    }
+
+    bool try_pop(size_t index, Task & task) {
+        WorkQueue & queue = queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        queued_.fetch_sub(1);
+        return true;
+    }
+
+    bool try_steal(size_t index, Task & task) {
+        if (queued_.load(std::memory_order_relaxed) == 0)
+            return false;
+        for (size_t i = 1; i < thread_count_; i++) {
+            size_t victim = (index + i) % thread_count_;
+            WorkQueue & queue = queues_[victim];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void worker_loop(size_t index) {
+        ThreadInfo & info = thread_info();
+        info.pool = this;
+        info.index = index;
+
+        while (!stop_.load()) {
+            Task task;
+            if (try_pop(index, task) || try_steal(index, task)) {
+                run_task(task);
+            } else {
+                std::unique_lock<std::mutex> lock(sleep_mutex_);
+                sleepers_.fetch_add(1);
+                sleep_cond_.wait(lock, [this]() {
+                    return (this->stop_.load() || this->queued_.load() != 0);
+                });
+                sleepers_.fetch_sub(1);
+            }
+        }
+    }
+};
+
+//
+// The shared pool, it uses all the hardware threads.
+//
+inline TaskPool & default_task_pool() {
+    static TaskPool s_task_pool(0);
+    return s_task_pool;
+}
+
+} // namespace jstd
+
+#endif // !JSTD_SUPPORT_TASK_POOL_H